@@ -0,0 +1,86 @@
+#include "AddressOracle.h"
+
+#include <algorithm>
+
+bool ReadableMap::readable(std::uintptr_t p, std::size_t n) const
+{
+    std::size_t hint = 0;
+    return readable(p, n, hint);
+}
+
+bool ReadableMap::readable(std::uintptr_t p, std::size_t n, std::size_t& hint) const
+{
+    if (p + n < p) return false;
+    if (hint < beg.size() && beg[hint] <= p && p + n <= end[hint]) return true;
+
+    // первый диапазон, начинающийся правее p; нужный — перед ним
+    const auto it = std::upper_bound(beg.begin(), beg.end(), p);
+    if (it == beg.begin()) return false;
+    const std::size_t i = (std::size_t)(it - beg.begin()) - 1;
+    if (p + n > end[i]) return false;
+    hint = i;
+    return true;
+}
+
+ReadableMap make_readable_map(const std::vector<Region>& regions)
+{
+    ReadableMap map;
+    for (const Region& r : regions) {
+        const auto b = reinterpret_cast<std::uintptr_t>(r.base);
+        if (!map.end.empty() && map.end.back() == b) map.end.back() = b + r.size;
+        else {
+            map.beg.push_back(b);
+            map.end.push_back(b + r.size);
+        }
+    }
+    return map;
+}
+
+AddressOracle::AddressOracle(const RegionProvider& provider)
+    : provider(provider)
+    , current(std::make_shared<const ReadableMap>())
+{
+}
+
+AddressOracle::~AddressOracle()
+{
+    stop();
+}
+
+void AddressOracle::refresh()
+{
+    std::lock_guard<std::mutex> lk(refreshMutex);
+    auto next = std::make_shared<ReadableMap>(make_readable_map(provider.enumerate()));
+
+    // карта та же — старый снимок остаётся, и потребителям незачем перепроверять свои адреса
+    const auto prev = snapshot();
+    if (prev->beg == next->beg && prev->end == next->end) return;
+    next->generation = ++generation;
+    current.store(std::move(next), std::memory_order_release);
+}
+
+void AddressOracle::start(std::chrono::milliseconds period)
+{
+    if (worker.joinable()) return;
+    refresh();
+    stopping = false;
+    worker = std::thread([this, period] {
+        std::unique_lock<std::mutex> lk(m);
+        while (!wake.wait_for(lk, period, [&] { return stopping; })) {
+            lk.unlock();
+            refresh();
+            lk.lock();
+        }
+        });
+}
+
+void AddressOracle::stop()
+{
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lk(m);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MemoryRegions.h"
+
+// Снимок читаемой памяти: непересекающиеся диапазоны [beg[i], end[i]) по возрастанию,
+// соседние регионы склеены. Проверка — двоичный поиск, без SEH и без системных вызовов.
+struct ReadableMap {
+    std::vector<std::uintptr_t> beg, end;
+    std::uint64_t generation = 0; // растёт при каждом изменении карты
+
+    bool readable(std::uintptr_t p, std::size_t n) const;
+    // hint — индекс диапазона прошлой удачной проверки: объекты одной кучи лежат рядом,
+    // и чаще всего ответ находится без поиска
+    bool readable(std::uintptr_t p, std::size_t n, std::size_t& hint) const;
+};
+
+// Карта по списку регионов (по возрастанию адреса); generation остаётся нулевым
+ReadableMap make_readable_map(const std::vector<Region>& regions);
+
+// Держит свежий ReadableMap. Фоновый поток перечисляет регионы раз в period и публикует
+// новый снимок, только если карта действительно изменилась. Снимок отстаёт от реальной
+// карты не больше чем на period: чтение, проверенное по нему, защищает от объектов
+// выгруженного уровня, но не от региона, освобождённого в эти миллисекунды.
+class AddressOracle {
+public:
+    explicit AddressOracle(const RegionProvider& provider = default_region_provider());
+    ~AddressOracle();
+
+    AddressOracle(const AddressOracle&) = delete;
+    AddressOracle& operator=(const AddressOracle&) = delete;
+
+    void start(std::chrono::milliseconds period = std::chrono::milliseconds(250));
+    void stop();
+
+    // Перечитать карту сейчас, в вызывающем потоке
+    void refresh();
+
+    // Текущий снимок; никогда не nullptr
+    std::shared_ptr<const ReadableMap> snapshot() const { return current.load(std::memory_order_acquire); }
+
+private:
+    const RegionProvider& provider;
+    std::atomic<std::shared_ptr<const ReadableMap>> current;
+    std::uint64_t generation = 0;
+    std::mutex refreshMutex; // refresh() зовут и фоновый поток, и пользователь
+
+    std::thread worker;
+    std::mutex m;
+    std::condition_variable wake;
+    bool stopping = false;
+};
@@ -0,0 +1,108 @@
+#include "CandidateVerifier.h"
+#include "FaultGuard.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+VerifyStats& VerifyStats::operator+=(const VerifyStats& o)
+{
+    checked += o.checked;
+    accepted += o.accepted;
+    rejectedUnmapped += o.rejectedUnmapped;
+    rejectedFault += o.rejectedFault;
+    rejectedName += o.rejectedName;
+    rejectedPosition += o.rejectedPosition;
+    return *this;
+}
+
+// Конец читаемого непрерывного участка, начинающегося с региона ri (соседние регионы склеиваются)
+static std::uintptr_t contiguous_end(const std::vector<Region>& regions, std::size_t ri)
+{
+    std::uintptr_t end = reinterpret_cast<std::uintptr_t>(regions[ri].base) + regions[ri].size;
+    for (std::size_t j = ri + 1; j < regions.size() && reinterpret_cast<std::uintptr_t>(regions[j].base) == end; ++j) {
+        end += regions[j].size;
+    }
+    return end;
+}
+
+static bool name_ok(const char* s, std::size_t avail, const VerifyOptions& opt)
+{
+    const std::size_t limit = std::min(avail, opt.maxNameLength + 1);
+    std::size_t len = 0;
+    for (; len < limit; ++len) {
+        const unsigned char c = (unsigned char)s[len];
+        if (c == 0) break;
+        if (c < 0x20 || c > 0x7E) return false;
+    }
+    return len < limit && len >= opt.minNameLength;
+}
+
+static bool position_ok(const float* p, const VerifyOptions& opt)
+{
+    for (int i = 0; i < 3; ++i) {
+        if (!std::isfinite(p[i]) || std::fabs(p[i]) > opt.worldBound) return false;
+    }
+    return true;
+}
+
+CandidateVerifier::CandidateVerifier(const std::vector<Region>& regions, const VerifyOptions& opt)
+    : regions(regions), opt(opt), name(opt.maxNameLength + 1)
+{
+}
+
+bool CandidateVerifier::accept(std::uintptr_t a)
+{
+    ++st.checked;
+
+    // Кандидаты и регионы отсортированы — идём по обоим спискам одним проходом
+    while (ri < regions.size() && reinterpret_cast<std::uintptr_t>(regions[ri].base) + regions[ri].size <= a) ++ri;
+    if (ri >= regions.size() || reinterpret_cast<std::uintptr_t>(regions[ri].base) > a) {
+        ++st.rejectedUnmapped;
+        return false;
+    }
+    if (runOf != ri) {
+        runEnd = contiguous_end(regions, ri);
+        runOf = ri;
+    }
+
+    float pos[3] = {};
+    const std::uintptr_t nameAddr = a + opt.nameOffset;
+    const std::uintptr_t posAddr = a + opt.positionOffset;
+    if (nameAddr + opt.minNameLength + 1 > runEnd || posAddr + sizeof(pos) > runEnd) {
+        ++st.rejectedUnmapped;
+        return false;
+    }
+
+    // одно защищённое копирование на кандидата вместо разыменований «вслепую»
+    const std::size_t nameAvail = std::min<std::size_t>(name.size(), runEnd - nameAddr);
+    const bool read = guarded([&] {
+        std::memcpy(name.data(), reinterpret_cast<const void*>(nameAddr), nameAvail);
+        std::memcpy(pos, reinterpret_cast<const void*>(posAddr), sizeof(pos));
+        });
+    if (!read) { ++st.rejectedFault; return false; }
+    if (!name_ok(name.data(), nameAvail, opt)) { ++st.rejectedName; return false; }
+    if (!position_ok(pos, opt)) { ++st.rejectedPosition; return false; }
+
+    ++st.accepted;
+    return true;
+}
+
+void CandidateVerifier::verify(std::span<const std::uintptr_t> addrs, std::vector<std::uintptr_t>& out)
+{
+    for (const std::uintptr_t a : addrs) {
+        if (accept(a)) out.push_back(a);
+    }
+}
+
+void verify_candidates(std::vector<std::uintptr_t>& addrs, const std::vector<Region>& regions,
+    const VerifyOptions& opt, VerifyStats* stats)
+{
+    CandidateVerifier v(regions, opt);
+    std::size_t out = 0;
+    for (std::size_t i = 0; i < addrs.size(); ++i) {
+        if (v.accept(addrs[i])) addrs[out++] = addrs[i];
+    }
+    addrs.resize(out);
+    if (stats) *stats = v.stats();
+}
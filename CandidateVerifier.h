@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "MemoryRegions.h"
+
+// Раскладка объекта игры, которую проверяет верификатор
+struct VerifyOptions {
+    std::size_t nameOffset = 0x30;      // имя хранится прямо в объекте, C-строкой
+    std::size_t positionOffset = 0x300; // Vec3 (3 float)
+    std::size_t minNameLength = 1;
+    std::size_t maxNameLength = 128;    // без нуля в этих пределах имя считается мусором
+    float worldBound = 100000.0f;       // |x|, |y|, |z| за этим пределом — не позиция
+};
+
+// Счётчики отказов: каждый кандидат попадает ровно в одну строку
+struct VerifyStats {
+    std::size_t checked = 0;
+    std::size_t accepted = 0;
+    std::size_t rejectedUnmapped = 0; // имя или позиция вне читаемой памяти
+    std::size_t rejectedFault = 0;    // память пропала между перечислением и чтением
+    std::size_t rejectedName = 0;     // пусто, слишком длинно или непечатаемые байты
+    std::size_t rejectedPosition = 0; // NaN/inf или вне мира
+
+    VerifyStats& operator+=(const VerifyStats& o);
+};
+
+// Отбрасывает ложные находки скана. addrs должны быть отсортированы (как их и отдаёт сканер),
+// regions — карта читаемой памяти, отсортированная по адресу. Порядок оставшихся сохраняется.
+void verify_candidates(std::vector<std::uintptr_t>& addrs, const std::vector<Region>& regions,
+    const VerifyOptions& opt = {}, VerifyStats* stats = nullptr);
+
+// Та же проверка для потокового скана: кандидаты приходят порциями по возрастанию адреса,
+// курсор по регионам сохраняется между порциями. regions должен пережить верификатор.
+class CandidateVerifier {
+public:
+    explicit CandidateVerifier(const std::vector<Region>& regions, const VerifyOptions& opt = {});
+
+    // Один кандидат; адрес не меньше предыдущего
+    bool accept(std::uintptr_t a);
+    // Прошедшие из addrs дописываются в out
+    void verify(std::span<const std::uintptr_t> addrs, std::vector<std::uintptr_t>& out);
+
+    const VerifyStats& stats() const { return st; }
+
+private:
+    const std::vector<Region>& regions;
+    VerifyOptions opt;
+    VerifyStats st;
+    std::vector<char> name;
+    std::size_t ri = 0;
+    std::uintptr_t runEnd = 0;
+    std::size_t runOf = (std::size_t)-1;
+};
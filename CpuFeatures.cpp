@@ -0,0 +1,95 @@
+#include "CpuFeatures.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+static inline void cpuid(int out[4], int leaf, int subleaf) {
+#if defined(_MSC_VER)
+    __cpuidex(out, leaf, subleaf);
+#else
+    unsigned a = 0, b = 0, c = 0, d = 0;
+    __cpuid_count(leaf, subleaf, a, b, c, d);
+    out[0] = (int)a; out[1] = (int)b; out[2] = (int)c; out[3] = (int)d;
+#endif
+}
+
+static inline unsigned long long xgetbv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned eax = 0, edx = 0;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+
+static CpuFeatures detect()
+{
+    CpuFeatures f;
+    int info[4] = { 0,0,0,0 };
+    cpuid(info, 0, 0);
+    const int maxLeaf = info[0];
+
+    cpuid(info, 1, 0);
+    f.sse2 = (info[3] & (1 << 26)) != 0;
+    f.sse41 = (info[2] & (1 << 19)) != 0;
+    f.fma = (info[2] & (1 << 12)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    const bool osx = (info[2] & (1 << 27)) != 0;
+    if (!(avx && osx)) return f;
+
+    // XCR0: биты 1 (XMM) и 2 (YMM) — ОС сохраняет YMM; 5..7 — opmask и ZMM
+    const unsigned long long xcr0 = xgetbv0();
+    const bool ymm = (xcr0 & 0x6) == 0x6;
+    const bool zmm = (xcr0 & 0xE6) == 0xE6;
+    f.avx = ymm;
+    f.fma = f.fma && ymm;
+    if (!ymm || maxLeaf < 7) return f;
+
+    int info7[4] = { 0,0,0,0 };
+    cpuid(info7, 7, 0);
+    f.avx2 = (info7[1] & (1 << 5)) != 0;
+    f.avx512f = zmm && (info7[1] & (1 << 16)) != 0;
+    f.avx512bw = zmm && (info7[1] & (1 << 30)) != 0;
+    return f;
+}
+
+const CpuFeatures& cpu_features()
+{
+    static const CpuFeatures f = detect();
+    return f;
+}
+
+ScanIsa best_scan_isa()
+{
+    static const ScanIsa isa = [] {
+        const CpuFeatures& f = cpu_features();
+        if (f.avx512f && f.avx512bw) return ScanIsa::AVX512;
+        if (f.avx2) return ScanIsa::AVX2;
+        if (f.sse2) return ScanIsa::SSE2;
+        return ScanIsa::Scalar;
+        }();
+    return isa;
+}
+
+ScanIsa resolve_scan_isa(ScanIsa requested)
+{
+    const ScanIsa best = best_scan_isa();
+    if (requested == ScanIsa::Auto || (int)requested > (int)best) return best;
+    return requested;
+}
+
+const char* scan_isa_name(ScanIsa isa)
+{
+    switch (isa) {
+    case ScanIsa::Auto:   return "auto";
+    case ScanIsa::Scalar: return "scalar";
+    case ScanIsa::SSE2:   return "sse2";
+    case ScanIsa::AVX2:   return "avx2";
+    case ScanIsa::AVX512: return "avx512";
+    }
+    return "?";
+}
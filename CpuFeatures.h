@@ -0,0 +1,39 @@
+#pragma once
+
+// Набор инструкций для ядер сканера. Порядок важен: чем дальше, тем шире.
+enum class ScanIsa {
+    Auto,   // лучшее, что поддерживает CPU
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+struct CpuFeatures {
+    bool sse2 = false;
+    bool sse41 = false;
+    bool avx = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+};
+
+// Определяется один раз при первом вызове, дальше — из кэша
+const CpuFeatures& cpu_features();
+
+// Лучший доступный набор инструкций для ядер сканера
+ScanIsa best_scan_isa();
+
+// Запрошенный набор, ограниченный возможностями CPU (Auto -> лучший доступный)
+ScanIsa resolve_scan_isa(ScanIsa requested);
+
+const char* scan_isa_name(ScanIsa isa);
+
+// Атрибут для функций с интринсиками шире базового x64.
+// MSVC разрешает их без флагов компиляции, GCC/Clang — только с target.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define ISA_TARGET(x)
+#else
+#define ISA_TARGET(x) __attribute__((target(x)))
+#endif
@@ -0,0 +1,184 @@
+#include "EntityTable.h"
+#include "FaultGuard.h"
+
+#include <cstring>
+#include <immintrin.h>
+
+void EntityTable::clear()
+{
+    resize(0);
+}
+
+void EntityTable::reserve(std::size_t n)
+{
+    addr.reserve(n);
+    nameId.reserve(n);
+    x.reserve(n);
+    y.reserve(n);
+    z.reserve(n);
+    type.reserve(n);
+    dead.reserve(n);
+    readFrame.reserve(n);
+}
+
+void EntityTable::resize(std::size_t n)
+{
+    addr.resize(n);
+    nameId.resize(n);
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+    type.resize(n);
+    dead.resize(n);
+    readFrame.resize(n);
+}
+
+void EntityTable::append(std::span<const std::uintptr_t> addrs, std::uint8_t typeIndex, std::size_t nameOffset,
+    NameTable& names)
+{
+    // предел с запасом над VerifyOptions::maxNameLength — на случай, если имя успело поменяться
+    constexpr std::size_t kMaxName = 256;
+    char name[kMaxName];
+    const std::size_t first = size();
+    resize(first + addrs.size());
+    std::size_t out = first;
+    for (const std::uintptr_t a : addrs) {
+        // между проверкой кандидатов и приёмом объект мог освободиться (загрузка уровня):
+        // имя копируем под защитой, упавшую запись не добавляем
+        std::size_t len = 0;
+        const char* s = reinterpret_cast<const char*>(a + nameOffset);
+        if (!guarded([&] { len = strnlen(s, kMaxName); std::memcpy(name, s, len); })) continue;
+        addr[out] = a;
+        nameId[out] = names.intern(std::string_view(name, len));
+        x[out] = y[out] = z[out] = 0.0f;
+        type[out] = typeIndex;
+        dead[out] = 0;
+        readFrame[out] = 0;
+        ++out;
+    }
+    resize(out);
+}
+
+// Объект читается от vptr до конца позиции
+static inline std::size_t object_span(std::size_t positionOffset)
+{
+    return positionOffset + 3 * sizeof(float);
+}
+
+std::size_t EntityTable::refresh(std::uint64_t deadVptr, std::size_t positionOffset, const ReadableMap* valid)
+{
+    // объекты разбросаны по куче: без предвыборки каждый — два промаха кэша подряд
+    constexpr std::size_t kAhead = 8;
+    const std::size_t n = size();
+    const std::size_t span = object_span(positionOffset);
+    std::size_t hint = 0;
+    std::size_t out = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i + kAhead < n) {
+            const std::uintptr_t a = addr[i + kAhead];
+            _mm_prefetch(reinterpret_cast<const char*>(a), _MM_HINT_T0);
+            _mm_prefetch(reinterpret_cast<const char*>(a + positionOffset), _MM_HINT_T0);
+        }
+
+        const std::uintptr_t a = addr[i];
+        if (dead[i] || (valid && !valid->readable(a, span, hint))) continue;
+        if (*reinterpret_cast<const std::uint64_t*>(a) == deadVptr) continue;
+
+        const float* p = reinterpret_cast<const float*>(a + positionOffset);
+        if (out != i) {
+            addr[out] = a;
+            nameId[out] = nameId[i];
+            type[out] = type[i];
+            dead[out] = 0;
+            readFrame[out] = readFrame[i];
+        }
+        x[out] = p[0];
+        y[out] = p[1];
+        z[out] = p[2];
+        ++out;
+    }
+    resize(out);
+    return n - out;
+}
+
+std::size_t EntityTable::refresh(std::span<const std::uint32_t> idx, std::uint64_t deadVptr, std::size_t positionOffset,
+    const ReadableMap* valid)
+{
+    constexpr std::size_t kAhead = 8;
+    const std::size_t span = object_span(positionOffset);
+    std::size_t hint = 0;
+    std::size_t died = 0;
+    for (std::size_t k = 0; k < idx.size(); ++k) {
+        if (k + kAhead < idx.size()) {
+            const std::uintptr_t a = addr[idx[k + kAhead]];
+            _mm_prefetch(reinterpret_cast<const char*>(a), _MM_HINT_T0);
+            _mm_prefetch(reinterpret_cast<const char*>(a + positionOffset), _MM_HINT_T0);
+        }
+
+        const std::uint32_t i = idx[k];
+        if (dead[i]) continue;
+        const std::uintptr_t a = addr[i];
+        if ((valid && !valid->readable(a, span, hint)) || *reinterpret_cast<const std::uint64_t*>(a) == deadVptr) {
+            dead[i] = 1;
+            ++died;
+            continue;
+        }
+        const float* p = reinterpret_cast<const float*>(a + positionOffset);
+        x[i] = p[0];
+        y[i] = p[1];
+        z[i] = p[2];
+    }
+    return died;
+}
+
+std::size_t EntityTable::evictUnreadable(const ReadableMap& valid, std::size_t positionOffset)
+{
+    const std::size_t span = object_span(positionOffset);
+    std::size_t hint = 0;
+    std::size_t evicted = 0;
+    for (std::size_t i = 0; i < size(); ++i) {
+        if (dead[i] || valid.readable(addr[i], span, hint)) continue;
+        dead[i] = 1;
+        ++evicted;
+    }
+    return evicted;
+}
+
+bool EntityTable::compact()
+{
+    const std::size_t n = size();
+    std::size_t out = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (dead[i]) continue;
+        if (out != i) {
+            addr[out] = addr[i];
+            nameId[out] = nameId[i];
+            x[out] = x[i];
+            y[out] = y[i];
+            z[out] = z[i];
+            type[out] = type[i];
+            dead[out] = 0;
+            readFrame[out] = readFrame[i];
+        }
+        ++out;
+    }
+    resize(out);
+    return out != n;
+}
+
+void EntityTable::gather(std::span<const std::uint32_t> idx, EntitySubset& out,
+    std::span<const std::uint8_t> allowName) const
+{
+    out.index.clear();
+    out.x.clear();
+    out.y.clear();
+    out.z.clear();
+    for (const std::uint32_t i : idx) {
+        if (dead[i]) continue;
+        if (!allowName.empty() && !allowName[nameId[i]]) continue;
+        out.index.push_back(i);
+        out.x.push_back(x[i]);
+        out.y.push_back(y[i]);
+        out.z.push_back(z[i]);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "AddressOracle.h"
+#include "NameTable.h"
+
+// Выборка живых записей с позициями подряд — вход для project_batch
+struct EntitySubset {
+    std::vector<std::uint32_t> index; // индекс записи в EntityTable
+    std::vector<float> x, y, z;
+};
+
+// Кэш найденных объектов в виде структуры массивов: кадр проходит по плотным массивам,
+// а в память игры ходит один раз на объект.
+class EntityTable {
+public:
+    std::vector<std::uintptr_t> addr;
+    std::vector<std::uint32_t>  nameId; // имя в NameTable, прочитанное один раз при добавлении
+    std::vector<float>          x, y, z;
+    std::vector<std::uint8_t>   type; // индекс типа в скане, которым объект найден
+    std::vector<std::uint8_t>   dead; // vptr стал DeadEntity или память пропала, запись ждёт compact()
+    std::vector<std::uint32_t>  readFrame; // кадр UpdateScheduler, когда запись выбрана на чтение
+
+    std::size_t size() const { return addr.size(); }
+    bool empty() const { return addr.empty(); }
+    void clear();
+    void reserve(std::size_t n);
+
+    // Добавить объекты одного типа; имена интернируются в names, позиции заполняются
+    // при ближайшем refresh(). Имена должны быть проверены (verify_candidates); имя читается
+    // под guarded(), и объект, чья память успела пропасть, пропускается.
+    void append(std::span<const std::uintptr_t> addrs, std::uint8_t typeIndex, std::size_t nameOffset,
+        NameTable& names);
+
+    // Один проход за кадр: читает vptr и позицию каждого объекта с предвыборкой вперёд,
+    // объекты, чей vptr стал deadVptr, тут же вычёркиваются сдвигом. Возвращает число удалённых.
+    // valid (если задан) проверяется до чтения: объект вне читаемой памяти тоже вычёркивается.
+    std::size_t refresh(std::uint64_t deadVptr, std::size_t positionOffset, const ReadableMap* valid = nullptr);
+
+    // То же только для записей idx, без сдвига: мёртвые помечаются в dead, индексы остаются
+    // валидными до compact(). Возвращает число впервые найденных мёртвых.
+    std::size_t refresh(std::span<const std::uint32_t> idx, std::uint64_t deadVptr, std::size_t positionOffset,
+        const ReadableMap* valid = nullptr);
+
+    // Пометить мёртвыми все записи, чьи байты [addr, addr + positionOffset + 12) больше не
+    // читаемы по valid. Память игры не трогает. Возвращает число помеченных.
+    std::size_t evictUnreadable(const ReadableMap& valid, std::size_t positionOffset);
+
+    // Убрать помеченные записи; true — индексы сдвинулись
+    bool compact();
+
+    // allowName (если не пуст) — вердикты по nameId, записи со скрытым именем пропускаются
+    void gather(std::span<const std::uint32_t> idx, EntitySubset& out,
+        std::span<const std::uint8_t> allowName = {}) const;
+
+private:
+    void resize(std::size_t n);
+};
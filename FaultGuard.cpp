@@ -0,0 +1,109 @@
+#include "FaultGuard.h"
+
+#include <algorithm>
+#include <atomic>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <signal.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace fault_guard_detail {
+
+    static struct sigaction g_prevSegv {};
+    static struct sigaction g_prevBus {};
+
+    sigjmp_buf*& current_jump()
+    {
+        static thread_local sigjmp_buf* jb = nullptr;
+        return jb;
+    }
+
+    static void forward(int sig, siginfo_t* info, void* ctx)
+    {
+        const struct sigaction& prev = (sig == SIGBUS) ? g_prevBus : g_prevSegv;
+        if (prev.sa_flags & SA_SIGINFO) {
+            if (prev.sa_sigaction) { prev.sa_sigaction(sig, info, ctx); return; }
+        }
+        else if (prev.sa_handler != SIG_DFL && prev.sa_handler != SIG_IGN && prev.sa_handler) {
+            prev.sa_handler(sig);
+            return;
+        }
+        // Чужой сбой вне защищённой секции: возвращаем поведение по умолчанию,
+        // инструкция повторится и процесс упадёт как обычно.
+        signal(sig, SIG_DFL);
+    }
+
+    static void on_fault(int sig, siginfo_t* info, void* ctx)
+    {
+        if (sigjmp_buf* jb = current_jump()) {
+            siglongjmp(*jb, 1);
+        }
+        forward(sig, info, ctx);
+    }
+
+    void install_handlers()
+    {
+        static const bool installed = [] {
+            struct sigaction sa {};
+            sa.sa_sigaction = on_fault;
+            sa.sa_flags = SA_SIGINFO | SA_NODEFER | SA_ONSTACK;
+            sigemptyset(&sa.sa_mask);
+            sigaction(SIGSEGV, &sa, &g_prevSegv);
+            sigaction(SIGBUS, &sa, &g_prevBus);
+            return true;
+            }();
+        (void)installed;
+    }
+}
+#endif
+
+#ifdef _WIN32
+std::size_t read_self(void* dst, std::uintptr_t src, std::size_t n)
+{
+    // при сбое посреди диапазона (ERROR_PARTIAL_COPY) got — скопированное начало
+    SIZE_T got = 0;
+    if (!ReadProcessMemory(GetCurrentProcess(), reinterpret_cast<LPCVOID>(src), dst, n, &got)) {
+        return got <= n ? (std::size_t)got : 0;
+    }
+    return n;
+}
+#else
+std::size_t read_self(void* dst, std::uintptr_t src, std::size_t n)
+{
+    // Частичная копия у process_vm_readv — с точностью до элемента remote, поэтому режем
+    // диапазон по 4 КБ (страница не меньше): сбой обрывает копию ровно на своей странице
+    constexpr std::size_t kPiece = 4096;
+    constexpr std::size_t kIov = 64;
+    // -1 с ENOSYS/EPERM — вызов закрыт (seccomp, старое ядро); дальше копируем под guarded()
+    static std::atomic<bool> syscallOk{ true };
+    auto* const out = static_cast<std::uint8_t*>(dst);
+    std::size_t done = 0;
+    while (done < n && syscallOk.load(std::memory_order_relaxed)) {
+        iovec remote[kIov];
+        std::size_t k = 0, want = 0;
+        for (; k < kIov && done + want < n; ++k) {
+            const std::uintptr_t a = src + done + want;
+            const std::size_t piece = std::min(n - done - want, kPiece - (a & (kPiece - 1)));
+            remote[k] = { reinterpret_cast<void*>(a), piece };
+            want += piece;
+        }
+        iovec local{ out + done, want };
+        const ssize_t got = process_vm_readv(getpid(), &local, 1, remote, k, 0);
+        if (got < 0) {
+            if (errno == EFAULT) return done;
+            syscallOk.store(false, std::memory_order_relaxed);
+            break;
+        }
+        done += (std::size_t)got;
+        if ((std::size_t)got < want) return done;
+    }
+    while (done < n) {
+        const std::size_t piece = std::min(n - done, kPiece - ((src + done) & (kPiece - 1)));
+        if (!safe_copy(out + done, src + done, piece)) break;
+        done += piece;
+    }
+    return done;
+}
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <csetjmp>
+#endif
+
+// Защищённое выполнение кода, который может прочитать недоступную память.
+// Windows: SEH (__try/__except). Linux: обработчик SIGSEGV/SIGBUS + siglongjmp.
+// Внутри f() нельзя создавать объекты, которые должны корректно разрушиться при сбое.
+
+#ifndef _WIN32
+namespace fault_guard_detail {
+    sigjmp_buf*& current_jump();
+    void install_handlers();
+}
+#endif
+
+template <class F>
+inline bool guarded(F&& f)
+{
+#ifdef _WIN32
+    __try {
+        f();
+    }
+    __except (EXCEPTION_EXECUTE_HANDLER) {
+        return false;
+    }
+    return true;
+#else
+    fault_guard_detail::install_handlers();
+    sigjmp_buf jb;
+    sigjmp_buf* const prev = fault_guard_detail::current_jump();
+    fault_guard_detail::current_jump() = &jb;
+    // маску сигналов не сохраняем: обработчик ставится с SA_NODEFER, лишний syscall не нужен
+    if (sigsetjmp(jb, 0) != 0) {
+        fault_guard_detail::current_jump() = prev;
+        return false;
+    }
+    f();
+    fault_guard_detail::current_jump() = prev;
+    return true;
+#endif
+}
+
+// Одиночное 8-байтовое чтение, не падающее на недоступной странице
+inline bool safe_load_u64(std::uintptr_t p, std::uint64_t& v)
+{
+    return guarded([&] { v = *reinterpret_cast<const std::uint64_t*>(p); });
+}
+
+inline bool safe_copy(void* dst, std::uintptr_t src, std::size_t n)
+{
+    return guarded([&] { std::memcpy(dst, reinterpret_cast<const void*>(src), n); });
+}
+
+// Копия [src, src + n) средствами ОС, которые на недоступной странице возвращают ошибку,
+// а не бросают исключение: ReadProcessMemory / process_vm_readv к своему же процессу.
+// Один вызов на диапазон вместо защищённого чтения на каждое слово. Возвращает длину
+// скопированного начала: копия обрывается на первой нечитаемой странице.
+std::size_t read_self(void* dst, std::uintptr_t src, std::size_t n);
@@ -0,0 +1,149 @@
+#include "IncrementalScan.h"
+
+#include <atomic>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#ifdef _WIN32
+
+bool query_dirty_pages(std::uintptr_t beg, std::uintptr_t end, std::size_t ps,
+    std::vector<std::uint8_t>& dirty)
+{
+    const std::size_t pages = (end - beg + ps - 1) / ps;
+    dirty.assign(pages, 0);
+
+    // GetWriteWatch работает только для регионов, выделенных с MEM_WRITE_WATCH;
+    // для остальных вызов завершается ошибкой и мы уходим на отпечатки.
+    std::vector<PVOID> addrs(pages);
+    ULONG_PTR count = pages;
+    DWORD gran = 0;
+    if (GetWriteWatch(WRITE_WATCH_FLAG_RESET, reinterpret_cast<PVOID>(beg), end - beg,
+        addrs.data(), &count, &gran) != 0) {
+        return false;
+    }
+    for (ULONG_PTR i = 0; i < count; ++i) {
+        const std::size_t idx = (reinterpret_cast<std::uintptr_t>(addrs[i]) - beg) / ps;
+        if (idx < pages) dirty[idx] = 1;
+    }
+    return true;
+}
+
+void reset_dirty_pages()
+{
+}
+
+bool dirty_query_resets()
+{
+    return true;
+}
+
+std::uint64_t dirty_reset_epoch()
+{
+    return 1;
+}
+
+#else
+
+// soft-dirty — бит 55 записи /proc/self/pagemap
+static constexpr std::uint64_t kSoftDirty = 1ull << 55;
+
+static std::atomic<std::uint64_t> g_resetEpoch{ 0 };
+
+static bool write_clear_refs()
+{
+    // счётчик растёт и при неудаче: сброс мог пройти частично
+    g_resetEpoch.fetch_add(1, std::memory_order_acq_rel);
+    const int fd = open("/proc/self/clear_refs", O_WRONLY);
+    if (fd < 0) return false;
+    const bool ok = write(fd, "4", 1) == 1;
+    close(fd);
+    return ok;
+}
+
+static int pagemap_fd()
+{
+    static const int fd = open("/proc/self/pagemap", O_RDONLY);
+    return fd;
+}
+
+// Ядро без CONFIG_MEM_SOFT_DIRTY молча отдаёт нули — проверяем на собственной странице
+static bool soft_dirty_supported()
+{
+    static const bool ok = [] {
+        const long ps = sysconf(_SC_PAGESIZE);
+        if (pagemap_fd() < 0 || !write_clear_refs()) return false;
+        void* page = mmap(nullptr, ps, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (page == MAP_FAILED) return false;
+        *static_cast<volatile char*>(page) = 1;
+        std::uint64_t e = 0;
+        const off_t off = (off_t)(reinterpret_cast<std::uintptr_t>(page) / ps) * 8;
+        const bool got = pread(pagemap_fd(), &e, sizeof(e), off) == sizeof(e);
+        munmap(page, ps);
+        return got && (e & kSoftDirty) != 0;
+        }();
+    return ok;
+}
+
+bool query_dirty_pages(std::uintptr_t beg, std::uintptr_t end, std::size_t ps,
+    std::vector<std::uint8_t>& dirty)
+{
+    if (!soft_dirty_supported()) return false;
+
+    const std::size_t pages = (end - beg + ps - 1) / ps;
+    std::vector<std::uint64_t> entries(pages);
+    const off_t off = (off_t)(beg / ps) * 8;
+    const ssize_t want = (ssize_t)(pages * sizeof(std::uint64_t));
+    if (pread(pagemap_fd(), entries.data(), want, off) != want) return false;
+
+    dirty.resize(pages);
+    for (std::size_t i = 0; i < pages; ++i) dirty[i] = (entries[i] & kSoftDirty) ? 1 : 0;
+    return true;
+}
+
+void reset_dirty_pages()
+{
+    if (soft_dirty_supported()) write_clear_refs();
+}
+
+bool dirty_query_resets()
+{
+    return false;
+}
+
+std::uint64_t dirty_reset_epoch()
+{
+    return g_resetEpoch.load(std::memory_order_acquire);
+}
+
+#endif
+
+std::uint64_t page_fingerprint(std::uintptr_t p, std::size_t n)
+{
+    // четыре независимые цепочки умножения: упираемся в память, а не в латентность mul
+    const std::uint64_t* q = reinterpret_cast<const std::uint64_t*>(p);
+    const std::size_t words = n / 8;
+    std::uint64_t h0 = 0x9E3779B97F4A7C15ull, h1 = 0xC2B2AE3D27D4EB4Full;
+    std::uint64_t h2 = 0x165667B19E3779F9ull, h3 = 0x27D4EB2F165667C5ull;
+    std::size_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        h0 = (h0 ^ q[i + 0]) * 0x100000001B3ull;
+        h1 = (h1 ^ q[i + 1]) * 0x100000001B3ull;
+        h2 = (h2 ^ q[i + 2]) * 0x100000001B3ull;
+        h3 = (h3 ^ q[i + 3]) * 0x100000001B3ull;
+    }
+    for (; i < words; ++i) h0 = (h0 ^ q[i]) * 0x100000001B3ull;
+    std::uint64_t h = h0 ^ (h1 << 1 | h1 >> 63) ^ (h2 << 2 | h2 >> 62) ^ (h3 << 3 | h3 >> 61);
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    return h;
+}
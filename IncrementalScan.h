@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Как определять, какие страницы изменились с прошлого скана
+enum class ChangeDetection {
+    Auto,        // биты записи ОС там, где они есть, иначе отпечатки
+    Fingerprint, // хэш содержимого каждой страницы
+    DirtyBits    // только данные ОС (soft-dirty / GetWriteWatch); без них страница считается изменённой
+};
+
+// Сохранённый результат по одному чанку (см. split_into_chunks в ObjectScanner.cpp)
+struct IncrementalChunk {
+    std::uintptr_t beg = 0, end = 0;
+    bool tracked = false;                         // изменения страниц даёт ОС
+    std::vector<std::uint64_t> pageHash;          // отпечатки страниц, если !tracked
+    std::vector<std::vector<std::uintptr_t>> hits; // по вектору на иглу, по возрастанию адреса
+};
+
+// Состояние инкрементального скана между вызовами
+struct IncrementalScanState {
+    std::vector<std::uint64_t> needles;
+    bool unaligned = false;
+    std::size_t chunkSize = 0;
+    std::vector<std::vector<IncrementalChunk>> groups; // по группе на каждые NeedleSet::kMax игл
+
+    // Сброс битов записи, после которого этот state прочитал всю память заново (см.
+    // dirty_reset_epoch); 0 — такого не было, биты записи пока нельзя принимать на веру
+    std::uint64_t dirtyEpoch = 0;
+
+    // статистика последнего прохода
+    std::size_t pagesScanned = 0;
+    std::size_t pagesReused = 0;
+
+    void clear() { needles.clear(); groups.clear(); dirtyEpoch = 0; pagesScanned = pagesReused = 0; }
+};
+
+// Страницы [beg, end), в которые писали с прошлого reset_dirty_pages(): dirty[i] != 0.
+// false — ОС не отслеживает этот диапазон, нужно сравнивать отпечатки.
+bool query_dirty_pages(std::uintptr_t beg, std::uintptr_t end, std::size_t ps,
+    std::vector<std::uint8_t>& dirty);
+
+// Начать новый интервал наблюдения. На Linux — запись «4» в /proc/self/clear_refs;
+// на Windows сброс выполняет сам query_dirty_pages.
+void reset_dirty_pages();
+
+// true — query_dirty_pages сбрасывает биты сам и атомарно с чтением (GetWriteWatch).
+// Иначе (soft-dirty) сброс общий на процесс и отдельный: запись между чтением битов
+// и сбросом потерялась бы, поэтому после сброса вся память читается заново.
+bool dirty_query_resets();
+
+// Счётчик сбросов битов записи в процессе, с любого IncrementalScanState
+std::uint64_t dirty_reset_epoch();
+
+// Отпечаток n байт по адресу p (n кратно 8). Чтение не защищено — вызывать под guarded().
+std::uint64_t page_fingerprint(std::uintptr_t p, std::size_t n);
@@ -0,0 +1,61 @@
+#include "LabelLayout.h"
+
+#include <algorithm>
+#include <cmath>
+
+static inline bool overlaps(const LabelLayout::Placed& a, const LabelCandidate& b)
+{
+    return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+void LabelLayout::layout(std::vector<LabelCandidate>& candidates, float screenW, float screenH,
+    std::size_t budget, float cellSize)
+{
+    labels.clear();
+    droppedCount = mergedCount = 0;
+
+    const int cols = std::max(1, (int)std::ceil(screenW / cellSize));
+    const int rows = std::max(1, (int)std::ceil(screenH / cellSize));
+    // ячейки не освобождаются между кадрами, только опустошаются
+    if (cells.size() != (std::size_t)cols * rows) cells.resize((std::size_t)cols * rows);
+    for (auto& c : cells) c.clear();
+
+    std::sort(candidates.begin(), candidates.end(),
+        [](const LabelCandidate& a, const LabelCandidate& b) { return a.priority < b.priority; });
+
+    const float inv = 1.0f / cellSize;
+    for (const LabelCandidate& c : candidates) {
+        // текст может торчать за край экрана: такие ячейки прижимаются к крайним
+        const int cx0 = std::clamp((int)std::floor(c.x * inv), 0, cols - 1);
+        const int cx1 = std::clamp((int)std::floor((c.x + c.w) * inv), 0, cols - 1);
+        const int cy0 = std::clamp((int)std::floor(c.y * inv), 0, rows - 1);
+        const int cy1 = std::clamp((int)std::floor((c.y + c.h) * inv), 0, rows - 1);
+
+        std::int64_t hit = -1;
+        for (int cy = cy0; cy <= cy1 && hit < 0; ++cy)
+            for (int cx = cx0; cx <= cx1 && hit < 0; ++cx)
+                for (const std::uint32_t li : cells[(std::size_t)cy * cols + cx])
+                    if (overlaps(labels[li], c)) { hit = li; break; }
+
+        if (hit >= 0) {
+            if (labels[hit].nameId == c.nameId) {
+                ++labels[hit].merged;
+                ++mergedCount;
+            }
+            else {
+                ++droppedCount;
+            }
+            continue;
+        }
+        if (labels.size() >= budget) {
+            ++droppedCount;
+            continue;
+        }
+
+        const std::uint32_t li = (std::uint32_t)labels.size();
+        labels.push_back({ c.x, c.y, c.w, c.h, c.nameId, c.point });
+        for (int cy = cy0; cy <= cy1; ++cy)
+            for (int cx = cx0; cx <= cx1; ++cx)
+                cells[(std::size_t)cy * cols + cx].push_back(li);
+    }
+}
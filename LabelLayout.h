@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Подпись-кандидат: прямоугольник текста на экране и приоритет (меньше — важнее)
+struct LabelCandidate {
+    float x, y, w, h;
+    float priority;       // нормированное расстояние: ближние подписываются первыми
+    std::uint32_t nameId; // подписи с одним именем сливаются, а не вытесняют друг друга
+    std::uint32_t point;  // индекс точки у вызывающего
+};
+
+// Раскладка подписей без наложений. Экран делится на ячейки сетки занятости; кандидаты
+// идут по приоритету, и подпись, задевшая уже поставленную, выбрасывается — или, если
+// имя то же, засчитывается ей в merged. Не больше budget подписей за кадр.
+class LabelLayout {
+public:
+    struct Placed {
+        float x, y, w, h;
+        std::uint32_t nameId;
+        std::uint32_t point;
+        std::uint32_t merged = 0; // сколько одноимённых подписей поглощено этой
+    };
+
+    void layout(std::vector<LabelCandidate>& candidates, float screenW, float screenH,
+        std::size_t budget, float cellSize = 64.0f);
+
+    const std::vector<Placed>& placed() const { return labels; }
+    std::size_t dropped() const { return droppedCount; }
+    std::size_t merged() const { return mergedCount; }
+
+private:
+    std::vector<Placed> labels;
+    std::vector<std::vector<std::uint32_t>> cells; // ячейка -> поставленные подписи, задевающие её
+    std::size_t droppedCount = 0;
+    std::size_t mergedCount = 0;
+};
@@ -0,0 +1,112 @@
+#include "MarkerRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+
+const std::vector<ImVec2>& MarkerRenderer::unitCircle(int segments)
+{
+    if ((int)circles.size() <= segments) circles.resize(segments + 1);
+    auto& c = circles[segments];
+    if (c.empty()) {
+        c.resize(segments);
+        for (int i = 0; i < segments; ++i) {
+            const float a = 6.28318530718f * i / segments;
+            c[i] = ImVec2(std::cos(a), std::sin(a));
+        }
+    }
+    return c;
+}
+
+void MarkerRenderer::fan(ImDrawList* dl, float x, float y, float r, int segments, ImU32 col, ImVec2 uv)
+{
+    const auto& c = unitCircle(segments);
+    dl->PrimReserve(segments * 3, segments + 1);
+    const ImDrawIdx center = (ImDrawIdx)dl->_VtxCurrentIdx;
+    dl->PrimWriteVtx(ImVec2(x, y), uv, col);
+    for (int i = 0; i < segments; ++i) {
+        dl->PrimWriteVtx(ImVec2(x + c[i].x * r, y + c[i].y * r), uv, col);
+    }
+    for (int i = 0; i < segments; ++i) {
+        dl->PrimWriteIdx(center);
+        dl->PrimWriteIdx((ImDrawIdx)(center + 1 + i));
+        dl->PrimWriteIdx((ImDrawIdx)(center + 1 + (i + 1) % segments));
+    }
+}
+
+void MarkerRenderer::measureCircle(ImDrawList* dl, float r, std::size_t& vtx, std::size_t& idx)
+{
+    // тесселяция и кайма зависят от радиуса, флагов dl и общих данных — рисуем один круг
+    // в пустой список с теми же настройками
+    scratch._Data = dl->_Data;
+    scratch._ResetForNewFrame();
+    scratch.Flags = dl->Flags;
+    scratch.AddCircleFilled(ImVec2(0.0f, 0.0f), r, IM_COL32_WHITE);
+    vtx = (std::size_t)scratch.VtxBuffer.Size;
+    idx = (std::size_t)scratch.IdxBuffer.Size;
+}
+
+void MarkerRenderer::quad(ImDrawList* dl, float x, float y, float r, ImU32 col)
+{
+    dl->PrimReserve(6, 4);
+    dl->PrimRect(ImVec2(x - r, y - r), ImVec2(x + r, y + r), col);
+}
+
+const MarkerStats& MarkerRenderer::draw(ImDrawList* dl, const ProjectedPoints& pts, const MarkerStyle& style,
+    const ImVec4& colNear, const ImVec4& colFar)
+{
+    last = {};
+
+    // ближние первыми: нормированное расстояние уже посчитано project_batch
+    order.resize(pts.count);
+    for (std::uint32_t k = 0; k < pts.count; ++k) order[k] = k;
+    std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) { return pts.norm[a] < pts.norm[b]; });
+
+    const ImVec2 uv = dl->_Data->TexUvWhitePixel;
+    std::size_t circleVtx = 0, circleIdx = 0;
+    if (style.mode == MarkerMode::Circle) measureCircle(dl, style.radius, circleVtx, circleIdx);
+    const int maxSeg = std::clamp(style.maxSegments, 3, 64);
+    const int minSeg = std::clamp(style.minSegments, 3, maxSeg);
+    for (const std::uint32_t k : order) {
+        const float t = pts.norm[k];
+        const ImU32 col = ImGui::ColorConvertFloat4ToU32(ImVec4(
+            colNear.x + (colFar.x - colNear.x) * t, colNear.y + (colFar.y - colNear.y) * t,
+            colNear.z + (colFar.z - colNear.z) * t, colNear.w + (colFar.w - colNear.w) * t));
+
+        if (style.mode == MarkerMode::Circle) {
+            // цена круга известна из measureCircle, так что бюджет не превышается и на один круг
+            if (last.vertices + circleVtx > style.vertexBudget || last.indices + circleIdx > style.indexBudget) {
+                ++last.dropped;
+                continue;
+            }
+            const int v0 = dl->VtxBuffer.Size, i0 = dl->IdxBuffer.Size;
+            dl->AddCircleFilled(ImVec2(pts.u[k], pts.v[k]), style.radius, col);
+            last.vertices += dl->VtxBuffer.Size - v0;
+            last.indices += dl->IdxBuffer.Size - i0;
+            ++last.drawn;
+            continue;
+        }
+
+        int seg = 0; // 0 — квадрат
+        if (style.mode == MarkerMode::Fixed) seg = maxSeg;
+        else if (style.mode == MarkerMode::Lod) seg = maxSeg - (int)std::lround((maxSeg - minSeg) * std::clamp(t, 0.0f, 1.0f));
+
+        const bool fits = last.vertices + seg + 1 <= style.vertexBudget && last.indices + seg * 3 <= style.indexBudget;
+        if (seg && fits) {
+            fan(dl, pts.u[k], pts.v[k], style.radius, seg, col, uv);
+            last.vertices += seg + 1;
+            last.indices += seg * 3;
+        }
+        else if (last.vertices + 4 <= style.vertexBudget && last.indices + 6 <= style.indexBudget) {
+            quad(dl, pts.u[k], pts.v[k], style.radius * 0.886f, col); // та же площадь, что у круга
+            last.vertices += 4;
+            last.indices += 6;
+            if (seg) ++last.degraded;
+        }
+        else {
+            ++last.dropped;
+            continue;
+        }
+        ++last.drawn;
+    }
+    return last;
+}
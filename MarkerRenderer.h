@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "imgui.h"
+#include "Projector.h"
+
+// Как рисовать точки объектов
+enum class MarkerMode : int {
+    Circle, // AddCircleFilled с автоматической тесселяцией и сглаживанием — как раньше
+    Fixed,  // веер с постоянным числом сегментов
+    Lod,    // сегментов тем меньше, чем дальше объект
+    Quad    // квадрат: 4 вершины, 6 индексов
+};
+
+struct MarkerStyle {
+    MarkerMode mode = MarkerMode::Lod;
+    float radius = 15.0f;
+    int maxSegments = 12;  // Fixed и ближние в Lod
+    int minSegments = 4;   // дальние в Lod
+    std::size_t vertexBudget = 16384;
+    std::size_t indexBudget = 49152;
+};
+
+// Сколько бюджета съел кадр
+struct MarkerStats {
+    std::size_t drawn = 0;
+    std::size_t degraded = 0; // нарисованы квадратом, потому что на круг бюджета не хватило
+    std::size_t dropped = 0;  // не нарисованы вовсе
+    std::size_t vertices = 0;
+    std::size_t indices = 0;
+};
+
+// Пишет маркеры прямо в ImDrawList через PrimReserve, без сглаживающей каймы.
+// Ближние точки идут первыми: при нехватке бюджета деградируют и пропадают дальние.
+// Результат целиком определяется ImDrawList, так что его можно проверить без окна и GPU.
+class MarkerRenderer {
+public:
+    const MarkerStats& draw(ImDrawList* dl, const ProjectedPoints& pts, const MarkerStyle& style,
+        const ImVec4& colNear, const ImVec4& colFar);
+
+    const MarkerStats& stats() const { return last; }
+
+private:
+    void fan(ImDrawList* dl, float x, float y, float r, int segments, ImU32 col, ImVec2 uv);
+    void quad(ImDrawList* dl, float x, float y, float r, ImU32 col);
+    void measureCircle(ImDrawList* dl, float r, std::size_t& vtx, std::size_t& idx);
+    const std::vector<ImVec2>& unitCircle(int segments);
+
+    MarkerStats last;
+    std::vector<std::uint32_t> order;
+    std::vector<std::vector<ImVec2>> circles; // по числу сегментов: точки единичной окружности
+    ImDrawList scratch{ nullptr }; // пробный список для measureCircle
+};
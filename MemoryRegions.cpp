@@ -0,0 +1,237 @@
+#include "MemoryRegions.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <link.h>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#endif
+
+ScanPolicy ScanPolicy::heapOnly() {
+    ScanPolicy p;
+    p.types = TypePrivate;
+    p.requireProtect = ProtRead | ProtWrite;
+    p.forbidProtect = ProtExec | ProtNoCache;
+    return p;
+}
+
+ScanPolicy ScanPolicy::pointerSources() {
+    ScanPolicy p = heapOnly();
+    p.types = TypePrivate | TypeImage;
+    return p;
+}
+
+std::vector<Region> apply_scan_policy(std::vector<Region> regions, const ScanPolicy& policy,
+    RegionFilterStats* stats)
+{
+    RegionFilterStats st;
+    auto rejected = [&](const Region& r) {
+        st.bytesTotal += r.size;
+        ++st.regionsTotal;
+        if (!(policy.types & (1u << (int)r.type))) { st.skippedType += r.size; return true; }
+        if ((r.protect & policy.requireProtect) != policy.requireProtect ||
+            (r.protect & policy.forbidProtect) != 0) {
+            st.skippedProtect += r.size;
+            return true;
+        }
+        if (r.size < policy.minSize || r.size > policy.maxSize) { st.skippedSize += r.size; return true; }
+        if (r.type == RegionType::Image) {
+            const auto has = [&](const std::vector<std::uintptr_t>& v) {
+                return std::find(v.begin(), v.end(), r.owner) != v.end();
+                };
+            if ((!policy.onlyModules.empty() && !has(policy.onlyModules)) || has(policy.excludeModules)) {
+                st.skippedModule += r.size;
+                return true;
+            }
+        }
+        st.bytesKept += r.size;
+        ++st.regionsKept;
+        return false;
+        };
+    regions.erase(std::remove_if(regions.begin(), regions.end(), rejected), regions.end());
+    if (stats) *stats = st;
+    return regions;
+}
+
+#ifdef _WIN32
+
+static inline std::uint32_t to_region_protect(DWORD protect) {
+    if (protect & PAGE_GUARD) return 0;
+    std::uint32_t out = 0;
+    switch (protect & 0xFF) { // базовые флаги
+    case PAGE_READONLY:          out = ProtRead; break;
+    case PAGE_READWRITE:         out = ProtRead | ProtWrite; break;
+    case PAGE_WRITECOPY:         out = ProtRead | ProtWrite | ProtCopyOnWrite; break;
+    case PAGE_EXECUTE_READ:      out = ProtRead | ProtExec; break;
+    case PAGE_EXECUTE_READWRITE: out = ProtRead | ProtWrite | ProtExec; break;
+    case PAGE_EXECUTE_WRITECOPY: out = ProtRead | ProtWrite | ProtExec | ProtCopyOnWrite; break;
+    default:                     return 0;
+    }
+    if (protect & (PAGE_NOCACHE | PAGE_WRITECOMBINE)) out |= ProtNoCache;
+    return out;
+}
+
+static inline RegionType to_region_type(DWORD type) {
+    switch (type) {
+    case MEM_IMAGE:  return RegionType::Image;
+    case MEM_MAPPED: return RegionType::Mapped;
+    default:         return RegionType::Private;
+    }
+}
+
+std::vector<Region> Win32RegionProvider::enumerate() const {
+    SYSTEM_INFO si{};
+    GetSystemInfo(&si);
+
+    const auto minA = reinterpret_cast<std::uintptr_t>(si.lpMinimumApplicationAddress);
+    const auto maxA = reinterpret_cast<std::uintptr_t>(si.lpMaximumApplicationAddress);
+
+    std::vector<Region> out;
+    std::uintptr_t addr = minA;
+
+    while (addr < maxA) {
+        MEMORY_BASIC_INFORMATION mbi{};
+        SIZE_T got = VirtualQuery(reinterpret_cast<LPCVOID>(addr), &mbi, sizeof(mbi));
+        if (got == 0) break;
+
+        const auto base = reinterpret_cast<std::uintptr_t>(mbi.BaseAddress);
+        const auto size = static_cast<std::size_t>(mbi.RegionSize);
+        const std::uint32_t prot = to_region_protect(mbi.Protect);
+
+        if (mbi.State == MEM_COMMIT && (prot & ProtRead) && size != 0) {
+            const RegionType type = to_region_type(mbi.Type);
+            const std::uintptr_t owner = type == RegionType::Image
+                ? reinterpret_cast<std::uintptr_t>(mbi.AllocationBase) : 0;
+            out.push_back(Region{ reinterpret_cast<std::uint8_t*>(mbi.BaseAddress), size,
+                prot, type, owner });
+        }
+        // переход к следующему региону
+        const std::uintptr_t next = base + size;
+        if (next <= addr) break; // защита от зацикливания при некорректных данных
+        addr = next;
+    }
+    return out;
+}
+
+std::size_t Win32RegionProvider::pageSize() const {
+    static std::size_t s = [] {
+        SYSTEM_INFO si{}; GetSystemInfo(&si); return (std::size_t)si.dwPageSize;
+        }();
+    return s;
+}
+
+const RegionProvider& default_region_provider() {
+    static Win32RegionProvider p;
+    return p;
+}
+
+std::uintptr_t main_module_base() {
+    return reinterpret_cast<std::uintptr_t>(GetModuleHandle(NULL));
+}
+
+#else
+
+std::vector<Region> LinuxRegionProvider::enumerate() const {
+    std::vector<Region> out;
+    FILE* f = std::fopen("/proc/self/maps", "r");
+    if (!f) return out;
+
+    // Владелец образа — начало первого отображения того же файла (dev + inode)
+    char ownerDev[32] = {};
+    unsigned long long ownerInode = 0;
+    std::uintptr_t ownerBase = 0;
+
+    // Формат строки: start-end perms offset dev inode [path]
+    char line[4096 + 256];
+    while (std::fgets(line, sizeof(line), f)) {
+        const bool complete = std::strchr(line, '\n') != nullptr;
+
+        std::uintptr_t start = 0, end = 0;
+        char perms[5] = {};
+        unsigned long long offset = 0, inode = 0;
+        char dev[32] = {};
+        int pathPos = 0;
+        const int n = std::sscanf(line, "%" SCNxPTR "-%" SCNxPTR " %4s %llx %31s %llu %n",
+            &start, &end, perms, &offset, dev, &inode, &pathPos);
+
+        const char* path = line + pathPos;
+        if (!complete) {
+            // хвост слишком длинной строки (длинный путь) дочитываем и отбрасываем
+            char rest[256];
+            while (std::fgets(rest, sizeof(rest), f) && !std::strchr(rest, '\n')) {}
+        }
+
+        if (n < 6 || end <= start) continue;
+        if (perms[0] != 'r') continue;
+
+        // [vvar]/[vsyscall] отображаются читаемыми, но чтение из них может падать или не имеет смысла
+        if (std::strncmp(path, "[vvar", 5) == 0 || std::strncmp(path, "[vsyscall]", 10) == 0) continue;
+
+        std::uint32_t prot = ProtRead;
+        if (perms[1] == 'w') prot |= ProtWrite;
+        if (perms[2] == 'x') prot |= ProtExec;
+        const bool shared = perms[3] == 's';
+        if (!shared && (prot & ProtWrite) && inode != 0) prot |= ProtCopyOnWrite;
+
+        // Приватные файловые отображения — это почти всегда ELF-образы, загруженные ld.so
+        RegionType type = RegionType::Private;
+        if (shared) type = RegionType::Mapped;
+        else if (inode != 0) type = RegionType::Image;
+
+        std::uintptr_t owner = 0;
+        if (type == RegionType::Image) {
+            if (inode != ownerInode || std::strcmp(dev, ownerDev) != 0) {
+                ownerInode = inode;
+                std::strcpy(ownerDev, dev);
+                ownerBase = start;
+            }
+            owner = ownerBase;
+        }
+
+        // соседние записи с одинаковыми атрибутами склеиваем
+        if (!out.empty()) {
+            Region& last = out.back();
+            if (last.base + last.size == reinterpret_cast<std::uint8_t*>(start) &&
+                last.protect == prot && last.type == type && last.owner == owner) {
+                last.size += end - start;
+                continue;
+            }
+        }
+        out.push_back(Region{ reinterpret_cast<std::uint8_t*>(start), end - start, prot, type, owner });
+    }
+    std::fclose(f);
+    return out;
+}
+
+std::size_t LinuxRegionProvider::pageSize() const {
+    static std::size_t s = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return s;
+}
+
+const RegionProvider& default_region_provider() {
+    static LinuxRegionProvider p;
+    return p;
+}
+
+std::uintptr_t main_module_base() {
+    static std::uintptr_t base = [] {
+        std::uintptr_t b = 0;
+        // первый объект в списке dl_iterate_phdr — главный исполняемый файл
+        dl_iterate_phdr([](dl_phdr_info* info, size_t, void* data) {
+            *static_cast<std::uintptr_t*>(data) = static_cast<std::uintptr_t>(info->dlpi_addr);
+            return 1;
+            }, &b);
+        return b;
+        }();
+    return base;
+}
+
+#endif
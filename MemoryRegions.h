@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Тип региона: приватная память (кучи, стеки), образ модуля или файловое отображение
+enum class RegionType : std::uint8_t {
+    Private,
+    Image,
+    Mapped
+};
+
+// Флаги защиты, не зависящие от ОС
+enum RegionProtect : std::uint32_t {
+    ProtRead = 1u << 0,
+    ProtWrite = 1u << 1,
+    ProtExec = 1u << 2,
+    ProtCopyOnWrite = 1u << 3,
+    ProtNoCache = 1u << 4  // PAGE_NOCACHE / PAGE_WRITECOMBINE — обычно память, видимая GPU
+};
+
+struct Region {
+    std::uint8_t* base;
+    std::size_t   size;
+    std::uint32_t protect = ProtRead;
+    RegionType    type = RegionType::Private;
+    std::uintptr_t owner = 0; // для Image: база модуля, которому принадлежит регион
+};
+
+// Маска типов регионов для ScanPolicy
+enum RegionTypeMask : std::uint32_t {
+    TypePrivate = 1u << (int)RegionType::Private,
+    TypeImage = 1u << (int)RegionType::Image,
+    TypeMapped = 1u << (int)RegionType::Mapped,
+    TypeAny = TypePrivate | TypeImage | TypeMapped
+};
+
+// Какие регионы вообще стоит сканировать. Правила проверяются по порядку:
+// тип, защита, размер, модуль; байты отсеянного региона засчитываются первому сработавшему.
+struct ScanPolicy {
+    std::uint32_t types = TypeAny;
+    std::uint32_t requireProtect = ProtRead; // все эти флаги должны быть
+    std::uint32_t forbidProtect = 0;         // ни одного из этих
+    std::size_t minSize = 0;
+    std::size_t maxSize = std::numeric_limits<std::size_t>::max();
+    std::vector<std::uintptr_t> onlyModules;    // непусто — из образов берутся только эти модули
+    std::vector<std::uintptr_t> excludeModules; // образы этих модулей пропускаются
+
+    // Всё читаемое — поведение по умолчанию
+    static ScanPolicy everything() { return {}; }
+    // Только приватная RW-память без исполнения и без некэшируемых (GPU) отображений:
+    // кучи и стеки, где и живут объекты игры
+    static ScanPolicy heapOnly();
+    // Кучи плюс записываемые секции модулей: где могут лежать указатели на объекты,
+    // включая статические корни цепочек (см. PointerMap)
+    static ScanPolicy pointerSources();
+};
+
+// Сколько байт отсеяло каждое правило ScanPolicy
+struct RegionFilterStats {
+    std::size_t bytesTotal = 0;
+    std::size_t bytesKept = 0;
+    std::size_t skippedType = 0;
+    std::size_t skippedProtect = 0;
+    std::size_t skippedSize = 0;
+    std::size_t skippedModule = 0;
+    std::size_t regionsTotal = 0;
+    std::size_t regionsKept = 0;
+};
+
+// Источник карты памяти для сканера. Регионы возвращаются по возрастанию адреса
+// и не пересекаются.
+class RegionProvider {
+public:
+    virtual ~RegionProvider() = default;
+    virtual std::vector<Region> enumerate() const = 0;
+    virtual std::size_t pageSize() const = 0;
+};
+
+#ifdef _WIN32
+// VirtualQuery по всему пользовательскому адресному пространству
+class Win32RegionProvider : public RegionProvider {
+public:
+    std::vector<Region> enumerate() const override;
+    std::size_t pageSize() const override;
+};
+#else
+// Разбор /proc/self/maps
+class LinuxRegionProvider : public RegionProvider {
+public:
+    std::vector<Region> enumerate() const override;
+    std::size_t pageSize() const override;
+};
+#endif
+
+// Оставляет регионы, прошедшие policy; stats (если задан) получает разбивку отсеянного
+std::vector<Region> apply_scan_policy(std::vector<Region> regions, const ScanPolicy& policy,
+    RegionFilterStats* stats = nullptr);
+
+// Провайдер текущей платформы
+const RegionProvider& default_region_provider();
+
+// Базовый адрес исполняемого модуля процесса
+std::uintptr_t main_module_base();
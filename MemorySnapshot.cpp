@@ -0,0 +1,169 @@
+#include "MemorySnapshot.h"
+#include "FaultGuard.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0x100000
+#endif
+#endif
+
+static constexpr char kMagic[8] = "DWHSNAP";
+static constexpr std::uint32_t kVersion = 1;
+
+static bool all_zero(const std::uint8_t* p, std::size_t n)
+{
+    const std::uint64_t* q = reinterpret_cast<const std::uint64_t*>(p);
+    for (std::size_t i = 0; i < n / 8; ++i) {
+        if (q[i]) return false;
+    }
+    return true;
+}
+
+bool write_snapshot(const std::string& path, const RegionProvider& provider, const ScanPolicy& policy,
+    std::uintptr_t moduleBase, SnapshotStats* stats)
+{
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+
+    const std::size_t ps = provider.pageSize();
+    std::vector<Region> src = apply_scan_policy(provider.enumerate(), policy);
+    std::sort(src.begin(), src.end(), [](const Region& a, const Region& b) { return a.base < b.base; });
+
+    SnapshotStats st;
+    std::vector<SnapshotRegion> regions;
+    std::vector<SnapshotRun> runs;
+    std::vector<std::uint8_t> page(ps);
+    std::uint64_t offset = ps; // первая страница — под заголовок
+    bool ok = std::fseek(f, (long)ps, SEEK_SET) == 0;
+
+    for (const Region& r : src) {
+        if (!ok) break;
+        const auto beg = reinterpret_cast<std::uintptr_t>(r.base);
+        regions.push_back({ beg, r.size, r.protect, (std::uint32_t)r.type, r.owner });
+        ++st.regions;
+        st.bytes += r.size;
+
+        for (std::uintptr_t p = beg; p < beg + r.size && ok; p += ps) {
+            if (!safe_copy(page.data(), p, ps)) {
+                ++st.faultPages;
+                continue;
+            }
+            if (all_zero(page.data(), ps)) {
+                ++st.zeroPages;
+                continue;
+            }
+            ok = std::fwrite(page.data(), 1, ps, f) == ps;
+            ++st.dataPages;
+            // страница продолжает предыдущий участок и по адресу, и в файле — удлиняем его
+            if (!runs.empty() && runs.back().addr + runs.back().size == p
+                && runs.back().fileOffset + runs.back().size == offset) {
+                runs.back().size += ps;
+            }
+            else {
+                runs.push_back({ p, ps, offset });
+            }
+            offset += ps;
+        }
+    }
+
+    SnapshotHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.pageSize = (std::uint32_t)ps;
+    h.moduleBase = moduleBase;
+    h.regionCount = regions.size();
+    h.regionOffset = offset;
+    h.runCount = runs.size();
+    h.runOffset = offset + regions.size() * sizeof(SnapshotRegion);
+
+    ok = ok && std::fwrite(regions.data(), sizeof(SnapshotRegion), regions.size(), f) == regions.size();
+    ok = ok && std::fwrite(runs.data(), sizeof(SnapshotRun), runs.size(), f) == runs.size();
+    ok = ok && std::fseek(f, 0, SEEK_SET) == 0 && std::fwrite(&h, sizeof(h), 1, f) == 1;
+    ok = std::fclose(f) == 0 && ok;
+    if (stats) *stats = st;
+    return ok;
+}
+
+#ifndef _WIN32
+
+SnapshotRegionProvider::~SnapshotRegionProvider()
+{
+    close();
+}
+
+void SnapshotRegionProvider::close()
+{
+    for (const Region& r : regions) munmap(r.base, r.size);
+    regions.clear();
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    module = 0;
+    skipped = 0;
+    failed = 0;
+}
+
+template <class T>
+static bool read_table(int fd, std::uint64_t offset, std::uint64_t count, std::vector<T>& out)
+{
+    out.resize(count);
+    const ssize_t want = (ssize_t)(count * sizeof(T));
+    return pread(fd, out.data(), want, (off_t)offset) == want;
+}
+
+bool SnapshotRegionProvider::open(const std::string& path)
+{
+    close();
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    SnapshotHeader h{};
+    std::vector<SnapshotRegion> table;
+    std::vector<SnapshotRun> runs;
+    const std::size_t hostPage = (std::size_t)sysconf(_SC_PAGESIZE);
+    if (pread(fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h) || std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0
+        || h.version != kVersion || h.pageSize == 0 || h.pageSize % hostPage != 0
+        || !read_table(fd, h.regionOffset, h.regionCount, table) || !read_table(fd, h.runOffset, h.runCount, runs)) {
+        close();
+        return false;
+    }
+    page = h.pageSize;
+    module = (std::uintptr_t)h.moduleBase;
+
+    // регион целиком — анонимные нули по исходному адресу, поверх — участки файла
+    std::size_t ri = 0;
+    for (const SnapshotRegion& sr : table) {
+        void* want = reinterpret_cast<void*>(sr.base);
+        void* got = mmap(want, sr.size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+        const bool placed = got == want;
+        if (got != MAP_FAILED && !placed) munmap(got, sr.size); // старое ядро: флаг принят за подсказку
+
+        // участок, который не отобразился, оставил бы на своём месте нули — такой регион
+        // выдавал бы ложную картину памяти, поэтому его не отдаём вовсе
+        bool complete = placed;
+        for (; ri < runs.size() && runs[ri].addr < sr.base + sr.size; ++ri) {
+            if (!complete) continue;
+            void* const at = reinterpret_cast<void*>(runs[ri].addr);
+            if (mmap(at, runs[ri].size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, (off_t)runs[ri].fileOffset) != at) {
+                ++failed;
+                complete = false;
+            }
+        }
+        if (placed && !complete) munmap(want, sr.size);
+        if (!complete) {
+            ++skipped;
+            continue;
+        }
+        regions.push_back({ static_cast<std::uint8_t*>(want), (std::size_t)sr.size, sr.protect,
+            (RegionType)sr.type, (std::uintptr_t)sr.owner });
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MemoryRegions.h"
+
+// Снимок памяти процесса для воспроизведения скана вне игры.
+//
+// Файл: заголовок (первая страница), затем страницы данных подряд, в конце таблицы
+// регионов и участков. Участок — непрерывный кусок региона с ненулевыми страницами;
+// нулевые страницы не пишутся вовсе, при чтении на их месте анонимная память.
+// Данные лежат по смещениям, кратным странице, так что файл отображается как есть.
+
+struct SnapshotHeader {
+    char magic[8];              // "DWHSNAP"
+    std::uint32_t version;
+    std::uint32_t pageSize;
+    std::uint64_t moduleBase;   // main_module_base() процесса, с которого снят снимок
+    std::uint64_t regionCount;
+    std::uint64_t regionOffset; // SnapshotRegion[regionCount]
+    std::uint64_t runCount;
+    std::uint64_t runOffset;    // SnapshotRun[runCount], по возрастанию адреса
+};
+
+struct SnapshotRegion {
+    std::uint64_t base;
+    std::uint64_t size;
+    std::uint32_t protect;
+    std::uint32_t type;
+    std::uint64_t owner;
+};
+
+struct SnapshotRun {
+    std::uint64_t addr;
+    std::uint64_t size;
+    std::uint64_t fileOffset;
+};
+
+struct SnapshotStats {
+    std::size_t regions = 0;
+    std::size_t bytes = 0;       // объём снятых регионов
+    std::size_t dataPages = 0;   // записано в файл
+    std::size_t zeroPages = 0;   // пропущено как нулевые
+    std::size_t faultPages = 0;  // пропали во время снятия, записаны как нулевые
+};
+
+// Снять регионы provider, прошедшие policy, в файл path. Страницы читаются под guarded():
+// регион, освобождённый на ходу, даёт нули, а не падение.
+bool write_snapshot(const std::string& path, const RegionProvider& provider, const ScanPolicy& policy,
+    std::uintptr_t moduleBase, SnapshotStats* stats = nullptr);
+
+#ifndef _WIN32
+// Снимок, отображённый в память по исходным адресам: сканер, верификатор и EntityTable
+// работают с ним как с живым процессом, без копирования и без перевода адресов.
+// Регион, чей диапазон в этом процессе уже занят или чей участок не удалось отобразить
+// из файла, пропускается (см. skippedRegions, failedRuns).
+class SnapshotRegionProvider : public RegionProvider {
+public:
+    SnapshotRegionProvider() = default;
+    ~SnapshotRegionProvider() override;
+
+    SnapshotRegionProvider(const SnapshotRegionProvider&) = delete;
+    SnapshotRegionProvider& operator=(const SnapshotRegionProvider&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    std::vector<Region> enumerate() const override { return regions; }
+    std::size_t pageSize() const override { return page; }
+
+    std::uintptr_t moduleBase() const { return module; }
+    std::size_t skippedRegions() const { return skipped; }
+    std::size_t failedRuns() const { return failed; } // участки, на которых mmap файла не удался
+
+private:
+    int fd = -1;
+    std::size_t page = 4096;
+    std::uintptr_t module = 0;
+    std::size_t skipped = 0;
+    std::size_t failed = 0;
+    std::vector<Region> regions;
+};
+#endif
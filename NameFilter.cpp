@@ -0,0 +1,125 @@
+#include "NameFilter.h"
+
+#include <algorithm>
+#include <iterator>
+
+static inline char fold(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+}
+
+void NameFilter::Automaton::build(const std::vector<std::string>& patterns, const std::vector<std::uint32_t>& ruleOf)
+{
+    std::fill(std::begin(byteClass), std::end(byteClass), 0);
+    classes = 1;
+    for (const auto& p : patterns)
+        for (const unsigned char c : p)
+            if (byteClass[c] == 0) byteClass[c] = (std::uint8_t)classes++;
+
+    // бор; 0 в next — «перехода нет» (в корень переход не ведёт ни одно ребро бора)
+    next.assign(classes, 0);
+    out.assign(1, {});
+    for (std::size_t k = 0; k < patterns.size(); ++k) {
+        std::uint32_t s = 0;
+        for (const unsigned char c : patterns[k]) {
+            std::uint32_t& t = next[s * classes + byteClass[c]];
+            if (t == 0) {
+                t = (std::uint32_t)out.size();
+                out.emplace_back();
+                next.resize(next.size() + classes, 0);
+            }
+            s = next[s * classes + byteClass[c]];
+        }
+        out[s].push_back(ruleOf[k]);
+    }
+
+    // суффиксные ссылки обходом в ширину; недостающие переходы заполняются переходами
+    // по ссылке, так что поиск — ровно одно чтение таблицы на байт
+    std::vector<std::uint32_t> link(out.size(), 0), queue;
+    for (std::uint32_t c = 0; c < classes; ++c)
+        if (next[c]) queue.push_back(next[c]);
+    for (std::size_t qi = 0; qi < queue.size(); ++qi) {
+        const std::uint32_t s = queue[qi];
+        const auto& inherited = out[link[s]];
+        out[s].insert(out[s].end(), inherited.begin(), inherited.end());
+        for (std::uint32_t c = 0; c < classes; ++c) {
+            std::uint32_t& t = next[s * classes + c];
+            if (t) {
+                link[t] = next[link[s] * classes + c];
+                queue.push_back(t);
+            }
+            else {
+                t = next[link[s] * classes + c];
+            }
+        }
+    }
+}
+
+void NameFilter::compile(const std::vector<FilterRule>& rules)
+{
+    ruleList = rules;
+    hasInclude = false;
+
+    std::vector<std::string> exactPatterns, foldedPatterns;
+    std::vector<std::uint32_t> exactRules, foldedRules;
+    for (std::uint32_t i = 0; i < ruleList.size(); ++i) {
+        const FilterRule& r = ruleList[i];
+        if (r.pattern.empty()) continue;
+        hasInclude |= r.include;
+        if (r.ignoreCase) {
+            std::string p = r.pattern;
+            for (char& c : p) c = fold(c);
+            foldedPatterns.push_back(std::move(p));
+            foldedRules.push_back(i);
+        }
+        else {
+            exactPatterns.push_back(r.pattern);
+            exactRules.push_back(i);
+        }
+    }
+    exact.build(exactPatterns, exactRules);
+    folded.build(foldedPatterns, foldedRules);
+}
+
+bool NameFilter::scan(const Automaton& a, std::string_view text, bool& included) const
+{
+    std::uint32_t s = 0;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        s = a.next[s * a.classes + a.byteClass[(unsigned char)text[i]]];
+        for (const std::uint32_t ri : a.out[s]) {
+            const FilterRule& r = ruleList[ri];
+            // префиксное правило засчитывается, только если совпадение началось с нулевого байта
+            if (r.prefix && i + 1 != r.pattern.size()) continue;
+            if (!r.include) return true;
+            included = true;
+        }
+    }
+    return false;
+}
+
+bool NameFilter::accepts(std::string_view name) const
+{
+    bool included = false;
+    if (!exact.empty() && scan(exact, name, included)) return false;
+    if (!folded.empty()) {
+        char buf[256];
+        std::string slow;
+        char* low = buf;
+        if (name.size() > sizeof(buf)) {
+            slow.resize(name.size());
+            low = slow.data();
+        }
+        for (std::size_t i = 0; i < name.size(); ++i) low[i] = fold(name[i]);
+        if (scan(folded, std::string_view(low, name.size()), included)) return false;
+    }
+    return !hasInclude || included;
+}
+
+void NameFilter::classify(const NameTable& names, std::vector<std::uint8_t>& verdict) const
+{
+    const std::size_t from = verdict.size();
+    verdict.resize(names.size());
+    for (std::size_t id = from; id < names.size(); ++id) {
+        verdict[id] = accepts(names.str((std::uint32_t)id)) ? 1 : 0;
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "NameTable.h"
+
+// Правило фильтра имён
+struct FilterRule {
+    std::string pattern;
+    bool include = false;    // false — скрыть совпавшие; true — показывать только совпавшие
+    bool prefix = false;     // совпадение только с начала имени
+    bool ignoreCase = false; // ASCII без учёта регистра
+};
+
+// Правила, скомпилированные в автомат Ахо — Корасик: имя проходит за один проход
+// по байтам независимо от числа правил. Имя показывается, если не совпало ни одно
+// исключающее правило и (когда включающие есть) совпало хотя бы одно включающее.
+class NameFilter {
+public:
+    void compile(const std::vector<FilterRule>& rules);
+    const std::vector<FilterRule>& rules() const { return ruleList; }
+
+    bool accepts(std::string_view name) const;
+
+    // Вердикты для имён таблицы: verdict[id] != 0 — показывать. Считаются только имена
+    // с id >= verdict.size(), так что после compile() verdict нужно очистить.
+    void classify(const NameTable& names, std::vector<std::uint8_t>& verdict) const;
+
+private:
+    // Автомат над классами байтов: байты, которых нет в шаблонах, сливаются в класс 0,
+    // так что таблица переходов — состояния × (различных байтов + 1)
+    struct Automaton {
+        std::uint8_t byteClass[256] = {};
+        std::uint32_t classes = 1;
+        std::vector<std::uint32_t> next;              // next[state * classes + class]
+        std::vector<std::vector<std::uint32_t>> out;  // правила, заканчивающиеся в состоянии (с учётом суффиксов)
+
+        bool empty() const { return out.size() <= 1; }
+        void build(const std::vector<std::string>& patterns, const std::vector<std::uint32_t>& ruleOf);
+    };
+
+    // true — исключающее правило сработало, дальше можно не смотреть
+    bool scan(const Automaton& a, std::string_view text, bool& included) const;
+
+    std::vector<FilterRule> ruleList;
+    Automaton exact, folded; // folded получает имя в нижнем регистре
+    bool hasInclude = false;
+};
@@ -0,0 +1,11 @@
+#include "NameTable.h"
+
+std::uint32_t NameTable::intern(std::string_view s)
+{
+    if (auto it = ids.find(s); it != ids.end()) return it->second;
+
+    const std::uint32_t id = (std::uint32_t)strings.size();
+    strings.emplace_back(s);
+    ids.emplace(std::string_view(strings.back()), id);
+    return id;
+}
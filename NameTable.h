@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Интернированные имена объектов: одинаковые строки получают один id, и всё, что
+// зависит только от имени (вердикт фильтра, размеры текста), считается один раз на id.
+class NameTable {
+public:
+    std::uint32_t intern(std::string_view s);
+    const std::string& str(std::uint32_t id) const { return strings[id]; }
+    std::size_t size() const { return strings.size(); }
+
+private:
+    std::deque<std::string> strings; // deque: push_back не двигает строки, на которые смотрят ключи
+    std::unordered_map<std::string_view, std::uint32_t> ids; // ключи указывают в strings
+};
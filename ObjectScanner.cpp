@@ -1,345 +1,939 @@
 ﻿#include "ObjectScanner.h"
 
-#include <windows.h>
-#include <intrin.h>
+#include "FaultGuard.h"
+#include "IncrementalScan.h"
+#include "ScanKernels.h"
+#include "SignatureScanner.h"
+
 #include <cstdint>
 #include <vector>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <cstdio>
 #include <cstdlib>
 #include <algorithm>
 
-struct Region {
-    std::uint8_t* base;
-    std::size_t   size;
+static inline std::uintptr_t align_up(std::uintptr_t x, std::size_t a) { return (x + (a - 1)) & ~(std::uintptr_t)(a - 1); }
+static inline std::uintptr_t align_down(std::uintptr_t x, std::size_t a) { return x & ~(std::uintptr_t)(a - 1); }
+
+struct BucketMark {
+    std::size_t size[NeedleSet::kMax];
 };
-static inline std::size_t page_size() {
-    static std::size_t s = [] {
-        SYSTEM_INFO si{}; GetSystemInfo(&si); return (std::size_t)si.dwPageSize;
-        }();
-    return s;
-}
-static inline bool is_readable(DWORD protect) {
-    if (protect & PAGE_GUARD) return false;
-    const DWORD p = protect & 0xFF; // базовые флаги
-    switch (p) {
-    case PAGE_READONLY:
-    case PAGE_READWRITE:
-    case PAGE_WRITECOPY:
-    case PAGE_EXECUTE_READ:
-    case PAGE_EXECUTE_READWRITE:
-    case PAGE_EXECUTE_WRITECOPY:
-        return true;
-    default:
-        return false;
+static inline BucketMark mark_buckets(const HitBuckets& out)
+{
+    BucketMark m{};
+    for (std::size_t k = 0; k < out.size(); ++k) m.size[k] = out[k].size();
+    return m;
+}
+static inline void rollback_buckets(HitBuckets& out, const BucketMark& m)
+{
+    for (std::size_t k = 0; k < out.size(); ++k) out[k].resize(m.size[k]);
+}
+
+// Находки ядра, прошедшего по копии, переносим на настоящие адреса
+static inline void rebase_buckets(HitBuckets& out, const BucketMark& m, std::uintptr_t delta)
+{
+    for (std::size_t k = 0; k < out.size(); ++k) {
+        for (std::size_t j = m.size[k]; j < out[k].size(); ++j) out[k][j] += delta;
     }
 }
 
-static std::vector<Region> enumerate_readable_regions() {
-    SYSTEM_INFO si{};
-    GetSystemInfo(&si);
+// Буфер потока под копию страницы после сбоя. Копия лежит с тем же сдвигом от 64 байт,
+// что и оригинал, — ядра видят то же выравнивание.
+static std::uint8_t* staging_buffer(std::uintptr_t src, std::size_t n)
+{
+    thread_local std::vector<std::uint8_t> buf;
+    if (buf.size() < n + 128) buf.resize(n + 128);
+    return reinterpret_cast<std::uint8_t*>(align_up(reinterpret_cast<std::uintptr_t>(buf.data()), 64) + (src & 63));
+}
 
-    const auto minA = reinterpret_cast<std::uintptr_t>(si.lpMinimumApplicationAddress);
-    const auto maxA = reinterpret_cast<std::uintptr_t>(si.lpMaximumApplicationAddress);
+// Страничный скан: на каждую страницу — одна крупная попытка; при исключении страница
+// копируется одним вызовом read_self() и то же ядро проходит по копии.
+// Возвращает число страниц, ушедших в безопасный проход.
+static std::size_t scan_region_aligned_robust(const Region& r, const NeedleSet& ns, std::size_t ps,
+    HitBuckets& out, AlignedBlockKernel kernel)
+{
+    const std::uintptr_t beg = reinterpret_cast<std::uintptr_t>(r.base);
+    const std::uintptr_t end = beg + r.size;
 
-    std::vector<Region> out;
-    std::uintptr_t addr = minA;
+    std::uintptr_t cur = align_up(beg, 8);
+    const std::uintptr_t stop = align_down(end, 8);
+    std::size_t faults = 0;
+    if (cur >= stop) return faults;
 
-    while (addr < maxA) {
-        MEMORY_BASIC_INFORMATION mbi{};
-        SIZE_T got = VirtualQuery(reinterpret_cast<LPCVOID>(addr), &mbi, sizeof(mbi));
-        if (got == 0) break;
+    while (cur < stop) {
+        const std::uintptr_t page_end = std::min(stop, align_up(cur + 1, ps));
+        const BucketMark mark = mark_buckets(out);
 
-        const auto base = reinterpret_cast<std::uintptr_t>(mbi.BaseAddress);
-        const auto size = static_cast<std::size_t>(mbi.RegionSize);
+        // Быстрая попытка: целиком страница
+        const bool page_ok = guarded([&] { kernel(cur, page_end, ns, ps, out); });
 
-        if (mbi.State == MEM_COMMIT && is_readable(mbi.Protect) && size != 0) {
-            out.push_back(Region{ reinterpret_cast<std::uint8_t*>(mbi.BaseAddress), size });
+        if (!page_ok) {
+            // Страница оказалась с сюрпризами: сканируем читаемое начало её копии.
+            // Частичные находки из прерванной попытки отбрасываем, чтобы не задвоить их.
+            rollback_buckets(out, mark);
+            std::uint8_t* const buf = staging_buffer(cur, page_end - cur);
+            const std::size_t got = read_self(buf, cur, page_end - cur) & ~std::size_t(7);
+            const auto b = reinterpret_cast<std::uintptr_t>(buf);
+            kernel(b, b + got, ns, ps, out);
+            rebase_buckets(out, mark, cur - b);
+            ++faults;
         }
-        // переход к следующему региону
-        const std::uintptr_t next = base + size;
-        if (next <= addr) break; // защита от зацикливания при некорректных данных
-        addr = next;
+
+        cur = page_end;
     }
-    return out;
+    return faults;
 }
 
-static inline std::uintptr_t align_up(std::uintptr_t x, std::size_t a) { return (x + (a - 1)) & ~(std::uintptr_t)(a - 1); }
-static inline std::uintptr_t align_down(std::uintptr_t x, std::size_t a) { return x & ~(std::uintptr_t)(a - 1); }
+// Невыровненный (по каждому байту), тоже устойчивый. Начала берутся в пределах страницы,
+// а чтение заходит до 7 байт на следующую, так что игла на стыке страниц не теряется.
+// readEnd — докуда можно читать за концом r (игла на стыке со следующим куском или чанком
+// того же региона, см. region_end).
+static std::size_t scan_region_unaligned_robust(const Region& r, const NeedleSet& ns, std::size_t ps,
+    HitBuckets& out, UnalignedBlockKernel kernel, std::uintptr_t readEnd)
+{
+    const std::uintptr_t beg = reinterpret_cast<std::uintptr_t>(r.base);
+    const std::uintptr_t end = beg + r.size;
 
-// Проверка наличия AVX2 у CPU и поддержки ОС сохранения YMM‑состояния
-static bool cpu_has_avx2() {
-    int info[4] = { 0,0,0,0 };
-    __cpuid(info, 1);
-    const bool avx = (info[2] & (1 << 28)) != 0;
-    const bool osx = (info[2] & (1 << 27)) != 0;
-    if (!(avx && osx)) return false;
+    std::uintptr_t cur = beg;
+    std::size_t faults = 0;
 
-    // XCR0: биты 1 (XMM) и 2 (YMM) должны быть установлены
-    unsigned long long xcr0 = _xgetbv(0);
-    if ((xcr0 & 0x6) != 0x6) return false;
+    while (cur < end) {
+        const std::uintptr_t page_end = std::min(end, align_up(cur + 1, ps));
+        const std::uintptr_t read_end = std::min(std::max(end, readEnd), page_end + 7);
+        const BucketMark mark = mark_buckets(out);
+
+        const bool page_ok = guarded([&] { kernel(cur, read_end, ns, out); });
+        if (!page_ok) {
+            rollback_buckets(out, mark);
+            // Сбой мог быть и на соседней странице: свою копируем отдельно от стыка, чтобы
+            // нечитаемый сосед не отнял её целиком (ReadProcessMemory не обязан вернуть начало)
+            const std::size_t own = page_end - cur;
+            std::uint8_t* const buf = staging_buffer(cur, read_end - cur);
+            std::size_t got = read_self(buf, cur, own);
+            if (got < own) ++faults;
+            else got += read_self(buf + own, page_end, read_end - page_end);
+            const auto b = reinterpret_cast<std::uintptr_t>(buf);
+            kernel(b, b + got, ns, out);
+            rebase_buckets(out, mark, cur - b);
+        }
+        cur = page_end;
+    }
+    return faults;
+}
+
+// Кусок региона фиксированного размера — единица работы планировщика.
+// Чанки идут строго по возрастанию адреса, поэтому их порядковый номер задаёт порядок результатов.
+struct ScanChunk {
+    const Region* region;
+    std::uintptr_t beg, end;
+};
 
-    int info7[4] = { 0,0,0,0 };
-    __cpuidex(info7, 7, 0);
-    const bool avx2 = (info7[1] & (1 << 5)) != 0;
-    return avx2;
+// Докуда невыровненное чтение может заходить за конец чанка: игла на стыке чанков одного
+// региона читается целиком, за границу региона — нет
+static std::uintptr_t region_end(const ScanChunk& c)
+{
+    return reinterpret_cast<std::uintptr_t>(c.region->base) + c.region->size;
 }
 
-static inline void scan_block_scalar_aligned(std::uintptr_t p, std::uintptr_t pend,
-    std::uint64_t needle,
-    std::vector<std::uintptr_t>& out)
+static std::vector<ScanChunk> split_into_chunks(const std::vector<Region>& regions,
+    std::size_t chunk_size, std::size_t ps)
 {
-    for (; p + 8 <= pend; p += 8) {
-        if (*reinterpret_cast<const std::uint64_t*>(p) == needle) {
-            out.push_back(p);
+    // размер чанка — степень двойки не меньше страницы, границы выровнены по нему
+    std::size_t cs = ps;
+    while (cs < chunk_size) cs <<= 1;
+
+    std::vector<ScanChunk> chunks;
+    for (const Region& r : regions) {
+        const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(r.base) + r.size;
+        for (std::uintptr_t p = reinterpret_cast<std::uintptr_t>(r.base); p < end;) {
+            const std::uintptr_t next = std::min<std::uintptr_t>(end, align_down(p, cs) + cs);
+            chunks.push_back(ScanChunk{ &r, p, next });
+            p = next;
         }
     }
+    return chunks;
 }
 
-#ifdef __AVX2__
-#include <immintrin.h>
-static inline void scan_block_avx2_aligned(std::uintptr_t p, std::uintptr_t pend,
-    std::uint64_t needle,
-    std::vector<std::uintptr_t>& out)
+// Очередь чанков одного потока: непрерывный диапазон номеров.
+// Владелец берёт с начала (по возрастанию адреса), воры забирают половину с конца.
+struct alignas(64) ChunkQueue {
+    std::mutex m;
+    std::size_t begin = 0, end = 0;
+};
+
+static bool pop_chunk(ChunkQueue& q, std::size_t& out)
 {
-    const __m256i pat = _mm256_set1_epi64x((long long)needle);
+    std::lock_guard<std::mutex> lk(q.m);
+    if (q.begin >= q.end) return false;
+    out = q.begin++;
+    return true;
+}
 
-    // основной цикл по 32 байта
-    for (; p + 32 <= pend; p += 32) {
-        // PREFETCH безопасен, но чтобы не волноваться — подстрахуемся по границе страницы
-        if ((p & (page_size() - 1)) == 0) {
-            _mm_prefetch(reinterpret_cast<const char*>(p + 256), _MM_HINT_T0);
+static bool steal_chunks(std::vector<ChunkQueue>& queues, unsigned self)
+{
+    const unsigned nt = (unsigned)queues.size();
+    for (unsigned i = 1; i < nt; ++i) {
+        ChunkQueue& victim = queues[(self + i) % nt];
+        std::size_t b = 0, e = 0;
+        {
+            std::lock_guard<std::mutex> lk(victim.m);
+            const std::size_t left = victim.end - victim.begin;
+            if (victim.begin >= victim.end) continue;
+            const std::size_t take = std::max<std::size_t>(1, left / 2);
+            e = victim.end;
+            b = e - take;
+            victim.end = b;
         }
+        ChunkQueue& own = queues[self];
+        std::lock_guard<std::mutex> lk(own.m);
+        own.begin = b;
+        own.end = e;
+        return true;
+    }
+    return false;
+}
 
-        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
-        const __m256i eq = _mm256_cmpeq_epi64(v, pat);
-        const int mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
-        if (mask) {
-            if (mask & 0x1) out.push_back(p + 0);
-            if (mask & 0x2) out.push_back(p + 8);
-            if (mask & 0x4) out.push_back(p + 16);
-            if (mask & 0x8) out.push_back(p + 24);
-        }
+// Пул для прохода: внешний из опций или временный, на время одного вызова
+static ScanThreadPool& acquire_pool(const ScanOptions& opt, unsigned nt,
+    std::unique_ptr<ScanThreadPool>& ownPool)
+{
+    if (opt.pool) return *opt.pool;
+    ThreadPoolConfig cfg;
+    cfg.threads = nt;
+    cfg.avoidCallerCore = false;
+    ownPool = std::make_unique<ScanThreadPool>(cfg);
+    return *ownPool;
+}
+
+static bool cancelled(const ScanProgress* progress)
+{
+    return progress && progress->cancel.load(std::memory_order_relaxed);
+}
+
+// Раздаёт чанки nt воркерам пула с кражей работы и ждёт завершения.
+// init(tid) вызывается один раз на воркер, body(tid, i) — ровно один раз на каждый чанк,
+// если скан не отменили через progress. stats (если задан, по элементу на воркер) получает
+// время внутри body, число чанков и их байты.
+template <class Init, class Body>
+static void run_chunked(ScanThreadPool& pool, unsigned nt, const std::vector<ScanChunk>& chunks,
+    ScanProgress* progress, ScanThreadStats* stats, Init&& init, Body&& body)
+{
+    const std::size_t count = chunks.size();
+    // Стартовое распределение: каждому потоку — свой непрерывный отрезок чанков
+    std::vector<ChunkQueue> queues(nt);
+    for (unsigned t = 0; t < nt; ++t) {
+        queues[t].begin = count * t / nt;
+        queues[t].end = count * (t + 1) / nt;
     }
-    // хвост
-    for (; p + 8 <= pend; p += 8) {
-        if (*reinterpret_cast<const std::uint64_t*>(p) == needle) {
-            out.push_back(p);
+
+    pool.run(nt, [&](unsigned tid) {
+        init(tid);
+        for (;;) {
+            std::size_t i = 0;
+            if (cancelled(progress)) break;
+            if (!pop_chunk(queues[tid], i)) {
+                if (!steal_chunks(queues, tid)) break;
+                continue;
+            }
+            if (stats) {
+                const auto t0 = std::chrono::steady_clock::now();
+                body(tid, i);
+                stats[tid].busySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                ++stats[tid].chunks;
+                stats[tid].bytes += chunks[i].end - chunks[i].beg;
+            }
+            else {
+                body(tid, i);
+            }
+            if (progress) {
+                progress->bytesDone.fetch_add(chunks[i].end - chunks[i].beg, std::memory_order_relaxed);
+            }
         }
+        });
+}
+
+// Счётчики воркеров одного прохода — в профиль скана
+static void add_thread_stats(ScanProfile* profile, const std::vector<ScanThreadStats>& stats)
+{
+    if (!profile) return;
+    if (profile->threads.size() < stats.size()) profile->threads.resize(stats.size());
+    for (std::size_t t = 0; t < stats.size(); ++t) {
+        profile->threads[t] += stats[t];
+        profile->total += stats[t];
     }
+    ++profile->passes;
 }
-#endif
 
-// Медленный, но «непадающий» проход по странице: 8-байтовые чтения под SEH
-static inline void scan_block_scalar_safe(std::uintptr_t p, std::uintptr_t pend,
-    std::uint64_t needle,
-    std::vector<std::uintptr_t>& out)
+static unsigned worker_count(const ScanOptions& opt, std::size_t chunks)
 {
-    for (; p + 8 <= pend; p += 8) {
-        bool ok = false;
-        std::uint64_t v = 0;
-        __try {
-            v = *reinterpret_cast<const std::uint64_t*>(p);
-            ok = true;
+    unsigned nt = opt.threads ? opt.threads : 1;
+    nt = (unsigned)std::min<std::size_t>(nt, chunks);
+    return nt ? nt : 1;
+}
+
+// Находки, отложенные до своей очереди: блок фиксированной ёмкости из арены воркера
+struct HitBlock {
+    std::uintptr_t* addr = nullptr;
+    std::uint32_t count = 0;
+    std::uint32_t needle = 0;
+    int next = -1; // следующий блок того же чанка (или свободный блок того же воркера)
+};
+
+// Отдаёт находки в sink строго по порядку чанков. Чанк-«голова» (все до него уже отданы)
+// сливается в sink сразу по мере сканирования; остальные копят находки в блоках своего
+// воркера. Кончились блоки — воркер ждёт, пока его чанк станет головой или блоки вернутся.
+// Голова никогда не ждёт, поэтому скан не может встать. sink вызывается под мьютексом.
+class HitSequencer {
+public:
+    static constexpr std::size_t kBlockHits = 512;
+    static constexpr std::size_t kBlocksPerThread = 16;
+
+    HitSequencer(ScanThreadPool& pool, unsigned nt, std::size_t chunks, const ScanHitSink& sink,
+        std::size_t needleBase, const ScanProgress* progress)
+        : sink(sink), needleBase(needleBase), progress(progress), slots(chunks), freeHead(nt, -1)
+    {
+        blocks.resize(nt * kBlocksPerThread);
+        for (unsigned t = 0; t < nt; ++t) {
+            // арена живёт в пуле и переживает скан
+            auto& arena = pool.blockArena(t);
+            arena.resize(kBlocksPerThread * kBlockHits);
+            for (std::size_t j = 0; j < kBlocksPerThread; ++j) {
+                const int b = (int)(t * kBlocksPerThread + j);
+                blocks[b].addr = arena.data() + j * kBlockHits;
+                blocks[b].next = freeHead[t];
+                freeHead[t] = b;
+            }
         }
-        __except (EXCEPTION_EXECUTE_HANDLER) { ok = false; }
-        if (ok && v == needle) out.push_back(p);
     }
+
+    // Находки очередного куска чанка i, по возрастанию внутри каждой иглы; bucket очищается.
+    // false — скан отменили, пока воркер ждал блоков.
+    bool push(unsigned tid, std::size_t i, HitBuckets& bucket)
+    {
+        std::unique_lock<std::mutex> lk(m);
+        for (std::size_t k = 0; k < bucket.size(); ++k) {
+            const std::vector<std::uintptr_t>& src = bucket[k];
+            std::size_t pos = 0;
+            while (pos < src.size()) {
+                if (head == i) {
+                    deliverParked(i);
+                    sink(needleBase + k, std::span<const std::uintptr_t>(src.data() + pos, src.size() - pos));
+                    break;
+                }
+                const int b = freeHead[tid];
+                if (b < 0) {
+                    // wait_for, а не wait: отмену никто не сигналит через condition_variable
+                    vacancy.wait_for(lk, std::chrono::milliseconds(2),
+                        [&] { return freeHead[tid] >= 0 || head == i || cancelled(progress); });
+                    if (cancelled(progress)) return false;
+                    continue;
+                }
+                freeHead[tid] = blocks[b].next;
+                HitBlock& blk = blocks[b];
+                blk.count = (std::uint32_t)std::min(kBlockHits, src.size() - pos);
+                blk.needle = (std::uint32_t)k;
+                blk.next = -1;
+                std::copy_n(src.data() + pos, blk.count, blk.addr);
+                pos += blk.count;
+                Slot& sl = slots[i];
+                if (sl.last >= 0) blocks[sl.last].next = b; else sl.first = b;
+                sl.last = b;
+            }
+        }
+        lk.unlock();
+        for (auto& v : bucket) v.clear();
+        return true;
+    }
+
+    // Чанк i досканирован: если он голова — отдать его и все готовые за ним
+    void finish(std::size_t i)
+    {
+        std::lock_guard<std::mutex> lk(m);
+        slots[i].done = true;
+        if (head != i) return;
+        while (head < slots.size() && slots[head].done) deliverParked(head++);
+        vacancy.notify_all();
+    }
+
+private:
+    struct Slot {
+        int first = -1, last = -1;
+        bool done = false;
+    };
+
+    void deliverParked(std::size_t i)
+    {
+        Slot& sl = slots[i];
+        if (sl.first < 0) return;
+        for (int b = sl.first; b >= 0;) {
+            HitBlock& blk = blocks[b];
+            const int next = blk.next;
+            sink(needleBase + blk.needle, std::span<const std::uintptr_t>(blk.addr, blk.count));
+            const std::size_t owner = (std::size_t)b / kBlocksPerThread;
+            blk.next = freeHead[owner];
+            freeHead[owner] = b;
+            b = next;
+        }
+        sl.first = sl.last = -1;
+        vacancy.notify_all();
+    }
+
+    const ScanHitSink& sink;
+    const std::size_t needleBase;
+    const ScanProgress* progress;
+    std::mutex m;
+    std::condition_variable vacancy;
+    std::vector<Slot> slots;
+    std::vector<HitBlock> blocks;
+    std::vector<int> freeHead; // по списку свободных блоков на воркер
+    std::size_t head = 0;
+};
+
+// Кусок чанка, после которого находки уходят в секвенсор: ограничивает корзины воркера
+static constexpr std::size_t kStreamSlice = 64 * 1024;
+
+// Один проход по памяти для не более чем NeedleSet::kMax игл; находки иглы k уходят
+// в sink как needleBase + k
+static void scan_needle_group(const std::vector<ScanChunk>& chunks, std::size_t ps,
+    const NeedleSet& ns, const ScanOptions& opt, const ScanHitSink& sink, std::size_t needleBase)
+{
+    if (chunks.empty()) return;
+
+    unsigned nt = worker_count(opt, chunks.size());
+    std::unique_ptr<ScanThreadPool> ownPool;
+    ScanThreadPool& pool = acquire_pool(opt, nt, ownPool);
+    nt = std::min(nt, pool.size());
+
+    // набор инструкций выбирается один раз на проход, а не на каждый регион
+    const AlignedBlockKernel kernel = aligned_block_kernel(opt.isa);
+    const UnalignedBlockKernel ukernel = unaligned_block_kernel(opt.isa);
+    HitSequencer seq(pool, nt, chunks.size(), sink, needleBase, opt.progress);
+    const std::size_t slice = std::max(ps, kStreamSlice);
+    std::vector<ScanThreadStats> stats(opt.profile ? nt : 0);
+
+    run_chunked(pool, nt, chunks, opt.progress, opt.profile ? stats.data() : nullptr,
+        [&](unsigned tid) {
+            // буферы воркера живут в пуле: ёмкость сохраняется между сканами
+            auto& bucket = pool.hitBuffers(tid);
+            bucket.resize(ns.n);
+            for (auto& b : bucket) {
+                b.clear();
+                b.reserve(1 << 12); // небольшой запас, чтобы меньше реаллокаций
+            }
+        },
+        [&](unsigned tid, std::size_t i) {
+            auto& bucket = pool.hitBuffers(tid);
+            const ScanChunk& c = chunks[i];
+
+            for (std::uintptr_t sb = c.beg; sb < c.end;) {
+                const std::uintptr_t se = std::min<std::uintptr_t>(c.end, align_down(sb, slice) + slice);
+                const Region rg{ reinterpret_cast<std::uint8_t*>(sb), se - sb,
+                    c.region->protect, c.region->type };
+                const std::size_t faults = opt.unaligned
+                    ? scan_region_unaligned_robust(rg, ns, ps, bucket, ukernel, region_end(c))
+                    : scan_region_aligned_robust(rg, ns, ps, bucket, kernel);
+                if (opt.profile) {
+                    stats[tid].faultPages += faults;
+                    stats[tid].pages += (se - sb + ps - 1) / ps;
+                }
+                if (!seq.push(tid, i, bucket)) return;
+                sb = se;
+            }
+            seq.finish(i);
+        });
+    add_thread_stats(opt.profile, stats);
 }
 
-// Страничный скан: на каждую страницу — одна крупная попытка; при исключении fallback к безопасному проходу
-static void scan_region_aligned_robust(const Region& r, std::uint64_t needle,
-    std::vector<std::uintptr_t>& out, bool use_avx2)
+static void set_progress_total(ScanProgress* progress, const std::vector<ScanChunk>& chunks, std::size_t passes)
 {
-    const std::uintptr_t beg = reinterpret_cast<std::uintptr_t>(r.base);
-    const std::uintptr_t end = beg + r.size;
+    if (!progress) return;
+    std::size_t total = 0;
+    for (const ScanChunk& c : chunks) total += c.end - c.beg;
+    progress->bytesTotal.store(total * passes, std::memory_order_relaxed);
+    progress->bytesDone.store(0, std::memory_order_relaxed);
+}
 
-    std::uintptr_t cur = align_up(beg, 8);
-    const std::uintptr_t stop = align_down(end, 8);
-    if (cur >= stop) return;
+static NeedleSet needle_group(std::span<const std::uint64_t> needles, std::size_t first)
+{
+    NeedleSet ns;
+    ns.n = std::min(NeedleSet::kMax, needles.size() - first);
+    std::copy_n(needles.begin() + first, ns.n, ns.v);
+    return ns;
+}
 
-    const std::size_t ps = page_size();
+static std::vector<Region> enumerate_sorted(const RegionProvider& provider, const ScanOptions& opt)
+{
+    auto regions = apply_scan_policy(provider.enumerate(), opt.policy, opt.filterStats);
+    std::sort(regions.begin(), regions.end(),
+        [](const Region& a, const Region& b) { return a.base < b.base; });
+    return regions;
+}
 
-    while (cur < stop) {
-        const std::uintptr_t page_end = std::min(stop, align_up(cur + 1, ps));
+void scan_self_for_pointers_stream(std::span<const std::uint64_t> needles, const ScanHitSink& sink,
+    const ScanOptions& opt)
+{
+    static_assert(sizeof(void*) == 8, "Требуется x64.");
 
-        // Быстрая попытка: целиком страница
-        bool page_ok = true;
-        __try {
-#ifdef __AVX2__
-            if (use_avx2) scan_block_avx2_aligned(cur, page_end, needle, out);
-            else
-#endif
-                scan_block_scalar_aligned(cur, page_end, needle, out);
+    const auto t0 = std::chrono::steady_clock::now();
+    if (opt.profile) *opt.profile = {};
+    if (needles.empty()) return;
+
+    const RegionProvider& provider = opt.regions ? *opt.regions : default_region_provider();
+    const auto regions = enumerate_sorted(provider, opt);
+    if (regions.empty()) return;
+    const std::size_t ps = provider.pageSize();
+    const auto chunks = split_into_chunks(regions, opt.chunkSize, ps);
+    const std::size_t groupCount = (needles.size() + NeedleSet::kMax - 1) / NeedleSet::kMax;
+    set_progress_total(opt.progress, chunks, groupCount);
+
+    // находки считаем на выходе секвенсора: sink и так вызывается по одному
+    ScanHitSink counted;
+    if (opt.profile) {
+        counted = [&](std::size_t k, std::span<const std::uintptr_t> hits) {
+            opt.profile->hits += hits.size();
+            sink(k, hits);
+        };
+    }
+    const ScanHitSink& out = opt.profile ? counted : sink;
+
+    // Игл больше, чем помещается в один проход, — делим на группы
+    for (std::size_t first = 0; first < needles.size(); first += NeedleSet::kMax) {
+        scan_needle_group(chunks, ps, needle_group(needles, first), opt, out, first);
+    }
+    if (opt.profile) opt.profile->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+std::vector<std::vector<std::uintptr_t>>
+scan_self_for_pointers(std::span<const std::uint64_t> needles, const ScanOptions& opt)
+{
+    // поток уже упорядочен по адресу: достаточно дописывать в конец
+    HitBuckets result(needles.size());
+    scan_self_for_pointers_stream(needles,
+        [&](std::size_t k, std::span<const std::uintptr_t> hits) {
+            result[k].insert(result[k].end(), hits.begin(), hits.end());
+        },
+        opt);
+    return result;
+}
+
+// Изменилась ли страница pi чанка c с прошлого прохода prev (может быть nullptr).
+// dirty — данные ОС по страницам чанка или nullptr; без них страницы сравниваются по отпечаткам,
+// если fingerprint (отпечаток пишется в hash), и иначе считаются изменёнными.
+static bool page_changed(const ScanChunk& c, const IncrementalChunk* prev,
+    const std::vector<std::uint8_t>* dirty, bool fingerprint, std::size_t pi, std::size_t ps, std::uint64_t& hash)
+{
+    const std::size_t pages = (c.end - c.beg + ps - 1) / ps;
+    const bool reuse = prev && prev->beg == c.beg && prev->end == c.end;
+    if (dirty) return !reuse || !prev->tracked || (*dirty)[pi];
+    if (!fingerprint) return true;
+
+    const std::uintptr_t pb = c.beg + pi * ps;
+    const std::uintptr_t pe = std::min(c.end, pb + ps);
+    hash = 0;
+    const bool ok = guarded([&] { hash = page_fingerprint(pb, (pe - pb) & ~std::size_t(7)); });
+    return !ok || !reuse || prev->pageHash.size() != pages || prev->pageHash[pi] != hash;
+}
+
+// Первая страница чанка в невыровненном режиме. Её изменение нужно и соседу слева (игла на
+// стыке чанков), поэтому она проверяется один раз до прохода, а не каждым из двух воркеров.
+struct ChunkHead {
+    bool changed = true;
+    std::uint64_t hash = 0;
+    bool nextChanged = false; // первая страница следующего чанка того же региона
+};
+
+// Пересканировать один чанк с учётом прошлого состояния prev (может быть nullptr).
+// dirty и fingerprint — как в page_changed; head — только в невыровненном режиме.
+static void rescan_chunk(const ScanChunk& c, const IncrementalChunk* prev,
+    const std::vector<std::uint8_t>* dirty, bool fingerprint, const ChunkHead* head, const NeedleSet& ns,
+    std::size_t ps, const ScanOptions& opt, AlignedBlockKernel kernel, UnalignedBlockKernel ukernel,
+    IncrementalChunk& cur, ScanThreadStats& stats)
+{
+    const std::size_t pages = (c.end - c.beg + ps - 1) / ps;
+    cur.beg = c.beg;
+    cur.end = c.end;
+    cur.tracked = dirty != nullptr;
+    cur.hits.assign(ns.n, {});
+    if (!dirty && fingerprint) cur.pageHash.assign(pages, 0);
+
+    std::vector<std::uint8_t> changed(pages, 1);
+    for (std::size_t pi = 0; pi < pages; ++pi) {
+        std::uint64_t h = 0;
+        if (pi == 0 && head) {
+            changed[pi] = head->changed;
+            h = head->hash;
         }
-        __except (EXCEPTION_EXECUTE_HANDLER) {
-            page_ok = false;
+        else {
+            changed[pi] = page_changed(c, prev, dirty, fingerprint, pi, ps, h);
         }
+        if (!cur.pageHash.empty()) cur.pageHash[pi] = h;
+    }
+    // Невыровненная находка числится за страницей начала, а читается до 7 байт следующей:
+    // изменилась следующая (в том числе первая страница соседнего чанка) — перечитываем и эту,
+    // иначе игла на стыке осталась бы прежней
+    if (head) {
+        for (std::size_t pi = 0; pi + 1 < pages; ++pi) changed[pi] |= changed[pi + 1];
+        if (pages) changed[pages - 1] |= head->nextChanged;
+    }
 
-        if (!page_ok) {
-            // Страница оказалась с сюрпризами: медленный «безопасный» проход
-            scan_block_scalar_safe(cur, page_end, needle, out);
+    std::size_t cursor[NeedleSet::kMax] = {};
+    for (std::size_t pi = 0; pi < pages; ++pi) {
+        const std::uintptr_t pb = c.beg + pi * ps;
+        const std::uintptr_t pe = std::min(c.end, pb + ps);
+
+        if (!changed[pi]) {
+            // страница не менялась: переносим её находки из прошлого скана
+            for (std::size_t k = 0; k < ns.n; ++k) {
+                const auto& src = prev->hits[k];
+                std::size_t& j = cursor[k];
+                while (j < src.size() && src[j] < pb) ++j;
+                while (j < src.size() && src[j] < pe) cur.hits[k].push_back(src[j++]);
+            }
+            ++stats.pagesReused;
+            continue;
         }
 
-        cur = page_end;
+        const Region rg{ reinterpret_cast<std::uint8_t*>(pb), pe - pb, c.region->protect, c.region->type };
+        stats.faultPages += opt.unaligned
+            ? scan_region_unaligned_robust(rg, ns, ps, cur.hits, ukernel, region_end(c))
+            : scan_region_aligned_robust(rg, ns, ps, cur.hits, kernel);
+        ++stats.pages;
     }
 }
 
-// Невыровненный (по каждому байту), тоже устойчивый
-static void scan_region_unaligned_robust(const Region& r, std::uint64_t needle,
-    std::vector<std::uintptr_t>& out)
+std::vector<std::vector<std::uintptr_t>>
+scan_self_for_pointers_incremental(std::span<const std::uint64_t> needles,
+    IncrementalScanState& state, ChangeDetection mode, const ScanOptions& opt)
 {
-    const std::uintptr_t beg = reinterpret_cast<std::uintptr_t>(r.base);
-    const std::uintptr_t end = beg + r.size;
+    const auto t0 = std::chrono::steady_clock::now();
+    if (opt.profile) {
+        *opt.profile = {};
+        opt.profile->incremental = true;
+    }
+    HitBuckets result(needles.size());
+    if (needles.empty()) return result;
+
+    const RegionProvider& provider = opt.regions ? *opt.regions : default_region_provider();
+    const auto regions = enumerate_sorted(provider, opt);
+    const std::size_t ps = provider.pageSize();
+    const auto chunks = split_into_chunks(regions, opt.chunkSize, ps);
+
+    // Другой набор игл или параметры нарезки — прошлое состояние бесполезно
+    const bool sameSetup = state.needles.size() == needles.size() &&
+        std::equal(needles.begin(), needles.end(), state.needles.begin()) &&
+        state.unaligned == opt.unaligned && state.chunkSize == opt.chunkSize;
+    if (!sameSetup) {
+        state.clear();
+        state.needles.assign(needles.begin(), needles.end());
+        state.unaligned = opt.unaligned;
+        state.chunkSize = opt.chunkSize;
+    }
+    const std::size_t groupCount = (needles.size() + NeedleSet::kMax - 1) / NeedleSet::kMax;
+    state.groups.resize(groupCount);
+    set_progress_total(opt.progress, chunks, groupCount);
+    state.pagesScanned = state.pagesReused = 0;
+
+    // Биты записи снимаются до чтения памяти, так что запись во время скана попадёт в следующий
+    // интервал. Soft-dirty нельзя прочитать и сбросить одним действием: запись между чтением
+    // битов и сбросом потерялась бы навсегда. Поэтому биты не сбрасываются на каждом проходе,
+    // а копятся с последнего сброса, после которого память прочитана целиком. Сброс (и полный
+    // проход следом) — только когда база потеряна (сброс сделал кто-то ещё, первый проход) или
+    // изменённых страниц набралось больше четверти.
+    std::vector<std::vector<std::uint8_t>> dirty(chunks.size());
+    std::vector<std::uint8_t> tracked(chunks.size(), 0);
+    if (mode != ChangeDetection::Fingerprint) {
+        std::size_t trackedPages = 0, dirtyPages = 0;
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            tracked[i] = query_dirty_pages(chunks[i].beg, chunks[i].end, ps, dirty[i]) ? 1 : 0;
+            if (!tracked[i]) continue;
+            trackedPages += dirty[i].size();
+            dirtyPages += (std::size_t)std::count(dirty[i].begin(), dirty[i].end(), std::uint8_t(1));
+        }
+        const bool baseline = state.dirtyEpoch != 0 && state.dirtyEpoch == dirty_reset_epoch();
+        if (!dirty_query_resets() && trackedPages && (!baseline || dirtyPages * 4 > trackedPages)) {
+            reset_dirty_pages();
+            state.dirtyEpoch = dirty_reset_epoch();
+            for (std::size_t i = 0; i < chunks.size(); ++i) {
+                if (tracked[i]) std::fill(dirty[i].begin(), dirty[i].end(), std::uint8_t(1));
+            }
+        }
+    }
 
-    std::uintptr_t cur = beg;
-    const std::size_t ps = page_size();
+    // набор инструкций выбирается один раз на проход, а не на каждый регион
+    const AlignedBlockKernel kernel = aligned_block_kernel(opt.isa);
+    const UnalignedBlockKernel ukernel = unaligned_block_kernel(opt.isa);
 
-    while (cur < end) {
-        const std::uintptr_t page_end = std::min(end, align_up(cur + 1, ps));
+    for (std::size_t g = 0; g < groupCount; ++g) {
+        const NeedleSet ns = needle_group(needles, g * NeedleSet::kMax);
+        std::vector<IncrementalChunk>& prevChunks = state.groups[g];
 
-        bool page_ok = true;
-        __try {
-            for (std::uintptr_t p = cur; p + 8 <= page_end; ++p) {
-                if (*reinterpret_cast<const std::uint64_t*>(p) == needle) {
-                    out.push_back(p);
-                }
-            }
+        // Сопоставляем новые чанки со старыми: оба списка отсортированы по адресу
+        std::vector<const IncrementalChunk*> prevFor(chunks.size(), nullptr);
+        for (std::size_t i = 0, j = 0; i < chunks.size(); ++i) {
+            while (j < prevChunks.size() && prevChunks[j].beg < chunks[i].beg) ++j;
+            if (j < prevChunks.size() && prevChunks[j].beg == chunks[i].beg) prevFor[i] = &prevChunks[j];
         }
-        __except (EXCEPTION_EXECUTE_HANDLER) {
-            page_ok = false;
+
+        // без данных ОС в режиме DirtyBits страница всегда считается изменённой
+        const bool fingerprint = mode != ChangeDetection::DirtyBits;
+        std::vector<ChunkHead> heads(opt.unaligned ? chunks.size() : 0);
+        for (std::size_t i = 0; i < heads.size(); ++i) {
+            heads[i].changed = page_changed(chunks[i], prevFor[i], tracked[i] ? &dirty[i] : nullptr, fingerprint,
+                0, ps, heads[i].hash);
+            if (i > 0 && chunks[i - 1].region == chunks[i].region) heads[i - 1].nextChanged = heads[i].changed;
         }
-        if (!page_ok) {
-            // медленный безопасный проход по байтам
-            for (std::uintptr_t p = cur; p + 8 <= page_end; ++p) {
-                bool ok = false;
-                std::uint64_t v = 0;
-                __try {
-                    v = *reinterpret_cast<const std::uint64_t*>(p);
-                    ok = true;
-                }
-                __except (EXCEPTION_EXECUTE_HANDLER) { ok = false; }
-                if (ok && v == needle) out.push_back(p);
+
+        std::vector<IncrementalChunk> next(chunks.size());
+        if (!chunks.empty()) {
+            unsigned nt = worker_count(opt, chunks.size());
+            std::unique_ptr<ScanThreadPool> ownPool;
+            ScanThreadPool& pool = acquire_pool(opt, nt, ownPool);
+            nt = std::min(nt, pool.size());
+
+            std::vector<ScanThreadStats> stats(nt);
+            run_chunked(pool, nt, chunks, opt.progress, opt.profile ? stats.data() : nullptr,
+                [](unsigned) {},
+                [&](unsigned tid, std::size_t i) {
+                    rescan_chunk(chunks[i], prevFor[i], tracked[i] ? &dirty[i] : nullptr, fingerprint,
+                        heads.empty() ? nullptr : &heads[i], ns, ps, opt, kernel, ukernel, next[i], stats[tid]);
+                });
+            for (unsigned t = 0; t < nt; ++t) {
+                state.pagesScanned += stats[t].pages;
+                state.pagesReused += stats[t].pagesReused;
             }
+            add_thread_stats(opt.profile, stats);
+        }
+        if (cancelled(opt.progress)) {
+            // часть чанков не обработана — такое состояние нельзя использовать как базу
+            state.clear();
+            if (opt.profile) opt.profile->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            return HitBuckets(needles.size());
+        }
+        prevChunks = std::move(next);
+
+        for (std::size_t k = 0; k < ns.n; ++k) {
+            std::size_t total = 0;
+            for (const auto& c : prevChunks) total += c.hits[k].size();
+            auto& out = result[g * NeedleSet::kMax + k];
+            out.reserve(total);
+            for (const auto& c : prevChunks) out.insert(out.end(), c.hits[k].begin(), c.hits[k].end());
+            if (opt.profile) opt.profile->hits += total;
         }
-        cur = page_end;
     }
+    if (opt.profile) opt.profile->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return result;
 }
 
+std::vector<std::uintptr_t>
+scan_self_for_pointer(std::uint64_t needle, const ScanOptions& opt)
+{
+    auto res = scan_self_for_pointers(std::span<const std::uint64_t>(&needle, 1), opt);
+    return std::move(res[0]);
+}
 
-// Скалярный выровненный скан (fallback без AVX2)
-static void scan_region_scalar_aligned(const Region& r, std::uint64_t needle,
-    std::vector<std::uintptr_t>& out)
+ObjectScanner::ObjectScanner(const ThreadPoolConfig& cfg)
+    : poolConfig(cfg)
 {
-    const std::uintptr_t beg = reinterpret_cast<std::uintptr_t>(r.base);
-    const std::uintptr_t end = beg + r.size;
-    std::uintptr_t p = align_up(beg, 8);
-    const std::uintptr_t stop = align_down(end, 8);
+}
 
-    for (; p + 8 <= stop; p += 8) {
-        if (*reinterpret_cast<const std::uint64_t*>(p) == needle) {
-            out.push_back(p);
-        }
-    }
+ObjectScanner::~ObjectScanner()
+{
+    cancelScan();
+    if (scanThread.joinable()) scanThread.join();
 }
 
-// Невыровненный скан: проверяем каждый байт (медленнее ~в 7–8×)
-static void scan_region_scalar_unaligned(const Region& r, std::uint64_t needle,
-    std::vector<std::uintptr_t>& out)
+bool ObjectScanner::configurePool(const ThreadPoolConfig& cfg)
 {
-    const std::uintptr_t beg = reinterpret_cast<std::uintptr_t>(r.base);
-    const std::uintptr_t end = beg + r.size;
+    if (scanRunning.load(std::memory_order_acquire)) return false;
+    if (scanThread.joinable()) scanThread.join();
+    std::lock_guard<std::mutex> lk(poolMutex);
+    poolConfig = cfg;
+    pool.reset();
+    return true;
+}
 
-    // Читаем 8‑байтовыми unaligned‑загрузками, не переходя границу региона.
-    for (std::uintptr_t p = beg; p + 8 <= end; ++p) {
-        if (*reinterpret_cast<const std::uint64_t*>(p) == needle) {
-            out.push_back(p);
-        }
+ScanThreadPool& ObjectScanner::threadPool()
+{
+    // Потоки создаются лениво: сканер — статический объект, а в DllMain запускать их нельзя
+    std::lock_guard<std::mutex> lk(poolMutex);
+    if (!pool) pool = std::make_unique<ScanThreadPool>(poolConfig);
+    return *pool;
+}
+
+void ObjectScanner::waitForScan()
+{
+    if (scanThread.joinable()) scanThread.join();
+}
+
+ScanOptions ObjectScanner::defaultOptions()
+{
+    ScanOptions opt;
+    opt.pool = &threadPool();
+    opt.threads = opt.pool->size();
+    opt.isa = isa;
+    opt.policy = policy;
+    return opt;
+}
+
+static const char* class_type_name(ClassType t)
+{
+    switch (t) {
+    case ClassType::Pickup:     return "Pickup";
+    case ClassType::Movable:    return "Movable";
+    case ClassType::Usable:     return "Usable";
+    case ClassType::DeadEntity: return "DeadEntity";
     }
+    return "";
 }
 
-struct ScanOptions {
-    bool unaligned = false;                 
-    unsigned threads = std::thread::hardware_concurrency();
-};
+void ObjectScanner::resolveAddresses(const std::string& rulesPath, const std::string& cachePath)
+{
+    rvas = resolve_signatures(load_signature_rules(rulesPath), main_module_base(), cachePath);
+}
 
-std::vector<std::uintptr_t>
-scan_self_for_pointer(std::uint64_t needle, const ScanOptions& opt = {})
+uintptr_t ObjectScanner::rva(const char* name, uintptr_t fallback) const
 {
-    static_assert(sizeof(void*) == 8, "Требуется x64.");
+    const auto it = rvas.find(name);
+    return it != rvas.end() ? it->second : fallback;
+}
 
-    auto regions = enumerate_readable_regions();
-    if (regions.empty()) return {};
+uintptr_t ObjectScanner::getCameraTransform() const
+{
+    return main_module_base() + rva("Camera", 0x2BC59A0);
+}
 
-    const bool use_avx2 = cpu_has_avx2() && !opt.unaligned;
-    unsigned nt = opt.threads ? opt.threads : 1;
-    nt = std::min<unsigned>(nt, regions.size());
-    if (nt == 0) nt = 1;
+uintptr_t ObjectScanner::classVptr(ClassType type) const
+{
+    return main_module_base() + rva(class_type_name(type), type);
+}
 
-    std::atomic<std::size_t> idx{ 0 };
-    std::vector<std::vector<std::uintptr_t>> buckets(nt);
+std::vector<uintptr_t> ObjectScanner::scanForType(ClassType typeForScan)
+{
+    waitForScan();
+    return scan_self_for_pointer(classVptr(typeForScan), defaultOptions());
+}
 
-    auto worker = [&](unsigned tid) {
-        auto& bucket = buckets[tid];
-        bucket.reserve(1 << 12); // небольшой запас, чтобы меньше реаллокаций
-        for (;;) {
-            const std::size_t i = idx.fetch_add(1, std::memory_order_relaxed);
-            if (i >= regions.size()) break;
+std::vector<std::uint64_t> ObjectScanner::vptrsFor(std::span<const ClassType> types) const
+{
+    std::vector<std::uint64_t> vptrs;
+    vptrs.reserve(types.size());
+    for (ClassType t : types) vptrs.push_back(classVptr(t));
+    return vptrs;
+}
 
-            const Region& rg = regions[i];
+std::vector<std::vector<uintptr_t>> ObjectScanner::scanForTypes(std::span<const ClassType> types)
+{
+    waitForScan();
+    return scan_self_for_pointers(vptrsFor(types), defaultOptions());
+}
+
+std::vector<std::vector<uintptr_t>> ObjectScanner::rescanForTypes(std::span<const ClassType> types,
+    ChangeDetection mode)
+{
+    waitForScan();
+    return scan_self_for_pointers_incremental(vptrsFor(types), incremental, mode, defaultOptions());
+}
+
+void ObjectScanner::resetIncremental()
+{
+    waitForScan();
+    incremental.clear();
+}
+
+void ObjectScanner::verifyCandidates(std::vector<uintptr_t>& addrs, VerifyStats* stats)
+{
+    verify_candidates(addrs, enumerate_sorted(default_region_provider(), ScanOptions{}), verifyOptions, stats);
+}
 
-            if (opt.unaligned) {
-                scan_region_unaligned_robust(rg, needle, bucket);
+bool ObjectScanner::startScanAsync(std::vector<ClassType> types, bool incrementalScan, ScanResultFilter filter)
+{
+    if (scanRunning.load(std::memory_order_acquire)) return false;
+    waitForScan();
+
+    progress.cancel.store(false, std::memory_order_relaxed);
+    progress.bytesDone.store(0, std::memory_order_relaxed);
+    progress.bytesTotal.store(0, std::memory_order_relaxed);
+    scanRunning.store(true, std::memory_order_release);
+
+    // Вызывают из Present: воркеры пула не должны садиться на ядро рендера
+    const int renderCore = current_cpu();
+
+    scanThread = std::thread([this, types = std::move(types), incrementalScan,
+        filter = std::move(filter), renderCore] {
+        threadPool().setReservedCore(renderCore);
+        auto result = std::make_shared<ScanResult>();
+        ScanOptions opt = defaultOptions();
+        opt.progress = &progress;
+        opt.filterStats = &result->filterStats;
+        opt.profile = &result->profile;
+
+        result->types = types;
+        if (incrementalScan) {
+            result->hits = scan_self_for_pointers_incremental(vptrsFor(types), incremental, ChangeDetection::Auto, opt);
+            if (verifyEnabled && !progress.cancel.load(std::memory_order_relaxed)) {
+                const auto regions = enumerate_sorted(default_region_provider(), ScanOptions{});
+                for (auto& bucket : result->hits) {
+                    VerifyStats st;
+                    verify_candidates(bucket, regions, verifyOptions, &st);
+                    result->verifyStats += st;
+                }
             }
-            else {
-#ifdef __AVX2__
-                const bool use_avx2 = cpu_has_avx2();
-#else
-                const bool use_avx2 = false;
-#endif
-                scan_region_aligned_robust(rg, needle, bucket, use_avx2);
+        }
+        else {
+            // Полный скан проверяет кандидатов прямо в потоке находок: сырые адреса не копятся
+            const auto regions = enumerate_sorted(default_region_provider(), ScanOptions{});
+            std::vector<CandidateVerifier> verifiers;
+            verifiers.reserve(types.size());
+            for (std::size_t k = 0; k < types.size(); ++k) verifiers.emplace_back(regions, verifyOptions);
+            result->hits.resize(types.size());
+            scan_self_for_pointers_stream(vptrsFor(types),
+                [&](std::size_t k, std::span<const std::uintptr_t> hits) {
+                    auto& out = result->hits[k];
+                    if (verifyEnabled) verifiers[k].verify(hits, out);
+                    else out.insert(out.end(), hits.begin(), hits.end());
+                },
+                opt);
+            if (verifyEnabled) {
+                for (const auto& v : verifiers) result->verifyStats += v.stats();
             }
-
         }
-        };
+        if (filter && !progress.cancel.load(std::memory_order_relaxed)) filter(*result);
 
-    std::vector<std::thread> pool;
-    pool.reserve(nt);
-    for (unsigned t = 0; t < nt; ++t) pool.emplace_back(worker, t);
-    for (auto& th : pool) th.join();
-
-    // Слить результаты
-    std::size_t total = 0;
-    for (auto& b : buckets) total += b.size();
-    std::vector<std::uintptr_t> out;
-    out.reserve(total);
-    for (auto& b : buckets) {
-        out.insert(out.end(), b.begin(), b.end());
-    }
-    std::sort(out.begin(), out.end());
-    out.erase(std::unique(out.begin(), out.end()), out.end());
-    return out;
+        if (!progress.cancel.load(std::memory_order_relaxed)) {
+            result->generation = ++publishedGeneration;
+            published.store(std::move(result), std::memory_order_release);
+        }
+        scanRunning.store(false, std::memory_order_release);
+        });
+    return true;
 }
 
-ObjectScanner::ObjectScanner()
+void ObjectScanner::cancelScan()
 {
+    progress.cancel.store(true, std::memory_order_relaxed);
 }
 
-ObjectScanner::~ObjectScanner()
+bool ObjectScanner::scanInProgress() const
 {
+    return scanRunning.load(std::memory_order_acquire);
 }
 
-uintptr_t ObjectScanner::getCameraTransform()
+float ObjectScanner::scanProgress() const
 {
-    HMODULE base = GetModuleHandle(NULL);
-    return ((uintptr_t)base + 0x2BC59A0);
+    const std::size_t total = progress.bytesTotal.load(std::memory_order_relaxed);
+    if (total == 0) return 0.0f;
+    return (float)progress.bytesDone.load(std::memory_order_relaxed) / (float)total;
 }
 
-std::vector<uintptr_t> ObjectScanner::scanForType(ClassType typeForScan)
+std::shared_ptr<ScanResult> ObjectScanner::takeScanResult()
 {
-    HMODULE base = GetModuleHandle(NULL);
-    uintptr_t classVptr = (uintptr_t)base + typeForScan;
-    return scan_self_for_pointer(classVptr);
+    // дешёвая проверка без обмена: в большинстве кадров нового результата нет
+    if (!published.load(std::memory_order_acquire)) return nullptr;
+    return published.exchange(nullptr, std::memory_order_acq_rel);
 }
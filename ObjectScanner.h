@@ -1,19 +1,148 @@
-#define NOMINMAX
-#include <Windows.h>
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
+#include "CandidateVerifier.h"
+#include "CpuFeatures.h"
+#include "IncrementalScan.h"
+#include "MemoryRegions.h"
+#include "Profiler.h"
+#include "ScanThreadPool.h"
+// Значения — RVA vtable классов для сборки, под которую писался код. Используются,
+// если адрес не нашёлся по сигнатуре (см. ObjectScanner::resolveAddresses).
 enum ClassType
 {
 	Pickup = 0x1c5e258,
 	Movable = 0x1c5de18,
-	Usable = 0x1c5ec38
+	Usable = 0x1c5ec38,
+	DeadEntity = 0x1afc930 // vptr, который объект получает после уничтожения
 };
 
+// Прогресс и отмена длинного скана; поля читаются из другого потока
+struct ScanProgress {
+	std::atomic<std::size_t> bytesDone{ 0 };
+	std::atomic<std::size_t> bytesTotal{ 0 };
+	std::atomic<bool> cancel{ false };
+};
+
+struct ScanOptions {
+	bool unaligned = false;
+	unsigned threads = std::thread::hardware_concurrency();
+	const RegionProvider* regions = nullptr; // nullptr — провайдер текущей платформы
+	std::size_t chunkSize = 1 << 20;         // регионы режутся на куски этого размера (кратно странице)
+	ScanThreadPool* pool = nullptr;          // nullptr — потоки создаются на время вызова
+	ScanProgress* progress = nullptr;        // при отмене возвращается неполный результат
+	ScanIsa isa = ScanIsa::Auto;             // ручной выбор ядра (для замеров); недоступное CPU понижается
+	ScanPolicy policy;                       // какие регионы сканировать
+	RegionFilterStats* filterStats = nullptr; // сколько байт отсеяла policy
+	ScanProfile* profile = nullptr;          // время, байты и сбои по воркерам; перезаписывается
+};
+
+// Получатель находок потокового скана: needle — индекс в наборе игл, hits — очередная порция.
+// Зовётся из воркеров, но никогда одновременно и под общей блокировкой — должен быть быстрым.
+// Для каждой иглы адреса приходят строго по возрастанию.
+using ScanHitSink = std::function<void(std::size_t needle, std::span<const std::uintptr_t> hits)>;
+
+// Потоковый скан: находки отдаются в sink по порядку регионов, без общего списка и сортировки.
+// При отмене sink успевает получить только начало результата.
+void scan_self_for_pointers_stream(std::span<const std::uint64_t> needles, const ScanHitSink& sink,
+	const ScanOptions& opt = {});
+
+std::vector<std::uintptr_t>
+scan_self_for_pointer(std::uint64_t needle, const ScanOptions& opt = {});
+
+// Один проход по памяти для нескольких значений; результат — по корзине на каждую иглу
+std::vector<std::vector<std::uintptr_t>>
+scan_self_for_pointers(std::span<const std::uint64_t> needles, const ScanOptions& opt = {});
+
+// То же, но с памятью о прошлом проходе: перечитываются только изменившиеся страницы,
+// находки остальных берутся из state
+std::vector<std::vector<std::uintptr_t>>
+scan_self_for_pointers_incremental(std::span<const std::uint64_t> needles, IncrementalScanState& state,
+	ChangeDetection mode = ChangeDetection::Auto, const ScanOptions& opt = {});
+
+// Готовый результат фонового скана: по корзине адресов на каждый тип
+struct ScanResult {
+	std::vector<ClassType> types;
+	std::vector<std::vector<uintptr_t>> hits;
+	RegionFilterStats filterStats;
+	VerifyStats verifyStats; // суммарно по всем корзинам
+	ScanProfile profile;
+	std::uint64_t generation = 0;
+};
+// Дообработка результата в фоновом потоке перед публикацией (фильтры и т.п.)
+using ScanResultFilter = std::function<void(ScanResult&)>;
+
 class ObjectScanner {
 private:
+	ThreadPoolConfig poolConfig;
+	std::mutex poolMutex; // ленивое создание пула: его зовут и рендер, и фоновый скан
+	std::unique_ptr<ScanThreadPool> pool;
+	IncrementalScanState incremental;
+	ScanIsa isa = ScanIsa::Auto;
+	ScanPolicy policy = ScanPolicy::heapOnly();
+	VerifyOptions verifyOptions;
+	bool verifyEnabled = true;
+
+	std::thread scanThread;
+	ScanProgress progress;
+	std::atomic<bool> scanRunning{ false };
+	std::uint64_t publishedGeneration = 0;
+	std::atomic<std::shared_ptr<ScanResult>> published;
+	std::unordered_map<std::string, uintptr_t> rvas; // найденные по сигнатурам RVA по имени
+
+	ScanThreadPool& threadPool();
+	ScanOptions defaultOptions();
+	uintptr_t rva(const char* name, uintptr_t fallback) const;
+	std::vector<std::uint64_t> vptrsFor(std::span<const ClassType> types) const;
+	// Дождаться фонового скана: он делит с синхронными вызовами пул и incremental
+	void waitForScan();
 	public:
-	ObjectScanner();
+	ObjectScanner(const ThreadPoolConfig& cfg = {});
 	~ObjectScanner();
-	uintptr_t getCameraTransform();
+	// Новые размер/привязка пула; потоки пересоздадутся при следующем скане.
+	// false — идёт фоновый скан, пул занят и не меняется
+	bool configurePool(const ThreadPoolConfig& cfg);
+	// Принудительный набор инструкций для ядер скана (Auto — лучший доступный)
+	void setScanIsa(ScanIsa value) { isa = value; }
+	ScanIsa scanIsa() const { return resolve_scan_isa(isa); }
+	// Какие регионы сканировать; по умолчанию — только кучи (ScanPolicy::heapOnly)
+	void setScanPolicy(const ScanPolicy& value) { policy = value; }
+	const ScanPolicy& scanPolicy() const { return policy; }
+	// Проверка кандидатов после скана (имя, позиция); включена по умолчанию
+	void setVerifyOptions(const VerifyOptions& value, bool enabled = true) { verifyOptions = value; verifyEnabled = enabled; }
+	// Отсеять ложные находки в уже полученном списке (отсортированном по адресу)
+	void verifyCandidates(std::vector<uintptr_t>& addrs, VerifyStats* stats = nullptr);
+	// Найти адреса по файлу сигнатур (см. load_signature_rules) с кэшем по хэшу модуля.
+	// Имена правил: Camera, Pickup, Movable, Usable, DeadEntity; чего нет — берётся из
+	// встроенных RVA. Звать до первого скана и не из DllMain: идёт чтение всего кода модуля.
+	void resolveAddresses(const std::string& rulesPath, const std::string& cachePath);
+	uintptr_t getCameraTransform() const;
+	// Абсолютный адрес vtable класса
+	uintptr_t classVptr(ClassType type) const;
+	// Синхронные сканы сначала дожидаются фонового, если он идёт
 	std::vector<uintptr_t> scanForType(ClassType typeForScan);
+	std::vector<std::vector<uintptr_t>> scanForTypes(std::span<const ClassType> types);
+	// Инкрементальный пересбор: дешёвый, если с прошлого вызова изменилась малая часть памяти
+	std::vector<std::vector<uintptr_t>> rescanForTypes(std::span<const ClassType> types,
+		ChangeDetection mode = ChangeDetection::Auto);
+	void resetIncremental();
+	const IncrementalScanState& incrementalState() const { return incremental; }
+
+	// Фоновый скан: рендер не ждёт, результат забирается через takeScanResult().
+	// false — предыдущий скан ещё идёт.
+	bool startScanAsync(std::vector<ClassType> types, bool incrementalScan = false, ScanResultFilter filter = {});
+	void cancelScan();
+	bool scanInProgress() const;
+	float scanProgress() const; // 0..1
+	// Новый опубликованный результат или nullptr; не блокирует
+	std::shared_ptr<ScanResult> takeScanResult();
 
-};
\ No newline at end of file
+};
@@ -0,0 +1,219 @@
+#include "PointerMap.h"
+#include "FaultGuard.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <queue>
+#include <unordered_set>
+
+struct PointerEntry {
+    std::uint64_t value;
+    std::uintptr_t addr;
+    bool operator<(const PointerEntry& o) const { return value != o.value ? value < o.value : addr < o.addr; }
+};
+
+// Кусок региона-источника — единица работы воркера
+struct PointerPiece {
+    std::uintptr_t beg, end;
+};
+
+// Выровненные слова [p, pend), указывающие в targets. Чтение не защищено — вызывать под guarded().
+static void collect_pointers(std::uintptr_t p, std::uintptr_t pend, const ReadableMap& targets,
+    std::vector<PointerEntry>& out, std::size_t& hint)
+{
+    // грубый отсев одним сравнением: большинство слов кучи — не указатели
+    const std::uint64_t lo = targets.beg.front();
+    const std::uint64_t span = targets.end.back() - lo;
+    for (; p + 8 <= pend; p += 8) {
+        const std::uint64_t v = *reinterpret_cast<const std::uint64_t*>(p);
+        if (v - lo < span && targets.readable(v, 1, hint)) out.push_back({ v, p });
+    }
+}
+
+PointerMap build_pointer_map(const ScanOptions& opt)
+{
+    static_assert(sizeof(void*) == 8, "Требуется x64.");
+
+    PointerMap map;
+    const RegionProvider& provider = opt.regions ? *opt.regions : default_region_provider();
+    auto all = provider.enumerate();
+    std::sort(all.begin(), all.end(), [](const Region& a, const Region& b) { return a.base < b.base; });
+    const ReadableMap targets = make_readable_map(all);
+    if (targets.beg.empty()) return map;
+    const auto sources = apply_scan_policy(std::move(all), opt.policy, opt.filterStats);
+    const std::size_t ps = provider.pageSize();
+
+    std::size_t cs = ps;
+    while (cs < opt.chunkSize) cs <<= 1;
+    std::vector<PointerPiece> pieces;
+    std::size_t total = 0;
+    for (const Region& r : sources) {
+        const auto b = reinterpret_cast<std::uintptr_t>(r.base);
+        if (r.type == RegionType::Image) {
+            map.imageBeg.push_back(b);
+            map.imageEnd.push_back(b + r.size);
+            map.imageOwner.push_back(r.owner);
+        }
+        // регионы выровнены по странице, так что куски тоже
+        for (std::uintptr_t p = b; p < b + r.size; p += cs) pieces.push_back({ p, std::min(b + r.size, p + cs) });
+        total += r.size;
+    }
+    if (pieces.empty()) return map;
+    if (opt.progress) {
+        opt.progress->bytesTotal.store(total, std::memory_order_relaxed);
+        opt.progress->bytesDone.store(0, std::memory_order_relaxed);
+    }
+    const auto cancelled = [&] { return opt.progress && opt.progress->cancel.load(std::memory_order_relaxed); };
+
+    unsigned nt = opt.threads ? opt.threads : 1;
+    nt = (unsigned)std::min<std::size_t>(nt, pieces.size());
+    std::unique_ptr<ScanThreadPool> ownPool;
+    if (!opt.pool) {
+        ThreadPoolConfig cfg;
+        cfg.threads = nt;
+        cfg.avoidCallerCore = false;
+        ownPool = std::make_unique<ScanThreadPool>(cfg);
+    }
+    ScanThreadPool& pool = opt.pool ? *opt.pool : *ownPool;
+    nt = std::min(nt, pool.size());
+
+    std::vector<std::vector<PointerEntry>> local(nt);
+    std::atomic<std::size_t> next{ 0 };
+    pool.run(nt, [&](unsigned tid) {
+        auto& out = local[tid];
+        std::vector<std::uint64_t> staging; // копия страницы после сбоя
+        std::size_t hint = 0;
+        for (;;) {
+            if (cancelled()) return;
+            const std::size_t i = next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= pieces.size()) break;
+            const PointerPiece& pc = pieces[i];
+            for (std::uintptr_t p = pc.beg; p < pc.end; p += ps) {
+                const std::uintptr_t pe = std::min(pc.end, p + ps);
+                const std::size_t mark = out.size();
+                if (guarded([&] { collect_pointers(p, pe, targets, out, hint); })) continue;
+                // страница пропала посреди прохода — проходим читаемое начало её копии
+                out.resize(mark);
+                staging.resize(ps / 8);
+                const std::size_t got = read_self(staging.data(), p, pe - p);
+                const auto b = reinterpret_cast<std::uintptr_t>(staging.data());
+                collect_pointers(b, b + got, targets, out, hint);
+                for (std::size_t j = mark; j < out.size(); ++j) out[j].addr = out[j].addr - b + p;
+            }
+            if (opt.progress) opt.progress->bytesDone.fetch_add(pc.end - pc.beg, std::memory_order_relaxed);
+        }
+        // сортировка тоже параллельна: на слияние остаются nt готовых списков
+        std::sort(out.begin(), out.end());
+        });
+    if (cancelled()) return map;
+
+    std::size_t count = 0;
+    for (const auto& v : local) count += v.size();
+    map.value.reserve(count);
+    map.addr.reserve(count);
+
+    using Head = std::pair<PointerEntry, unsigned>;
+    const auto later = [](const Head& a, const Head& b) { return b.first < a.first; };
+    std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
+    std::vector<std::size_t> pos(nt, 0);
+    for (unsigned t = 0; t < nt; ++t) {
+        if (!local[t].empty()) heads.push({ local[t][0], t });
+    }
+    while (!heads.empty()) {
+        const auto [e, t] = heads.top();
+        heads.pop();
+        map.value.push_back(e.value);
+        map.addr.push_back(e.addr);
+        if (++pos[t] < local[t].size()) heads.push({ local[t][pos[t]], t });
+        else std::vector<PointerEntry>().swap(local[t]); // отдаём память сразу, список исчерпан
+    }
+    return map;
+}
+
+std::span<const std::uintptr_t> PointerMap::referrers(std::uint64_t v) const
+{
+    const auto r = valueRange(v, v + 1);
+    return std::span<const std::uintptr_t>(addr.data() + r.first, r.second - r.first);
+}
+
+std::pair<std::size_t, std::size_t> PointerMap::valueRange(std::uint64_t lo, std::uint64_t hi) const
+{
+    const auto b = std::lower_bound(value.begin(), value.end(), lo);
+    const auto e = hi > lo ? std::lower_bound(b, value.end(), hi) : b;
+    return { (std::size_t)(b - value.begin()), (std::size_t)(e - value.begin()) };
+}
+
+std::uintptr_t PointerMap::moduleOf(std::uintptr_t a) const
+{
+    const auto it = std::upper_bound(imageBeg.begin(), imageBeg.end(), a);
+    if (it == imageBeg.begin()) return 0;
+    const std::size_t i = (std::size_t)(it - imageBeg.begin()) - 1;
+    return a < imageEnd[i] ? imageOwner[i] : 0;
+}
+
+bool PointerMap::isStatic(std::uintptr_t a, std::uintptr_t module) const
+{
+    const std::uintptr_t owner = moduleOf(a);
+    return owner != 0 && (module == 0 || owner == module);
+}
+
+std::vector<PointerChain> PointerMap::findChains(std::uintptr_t target, const PointerChainOptions& opt) const
+{
+    // узел — адрес, из которого одним разыменованием и смещением попадаем в узел parent
+    struct Node {
+        std::uintptr_t addr;
+        std::uint32_t parent;
+        std::uint32_t offset;
+    };
+    std::vector<Node> nodes{ { target, 0, 0 } };
+    std::unordered_set<std::uintptr_t> seen{ target };
+    std::vector<std::uint32_t> frontier{ 0 }, next;
+    std::vector<PointerChain> chains;
+
+    const auto emit = [&](std::uint32_t n) {
+        PointerChain c;
+        c.base = nodes[n].addr;
+        c.module = moduleOf(c.base);
+        for (; n != 0; n = nodes[n].parent) c.offsets.push_back(nodes[n].offset);
+        chains.push_back(std::move(c));
+    };
+
+    for (unsigned depth = 0; depth < opt.maxDepth && !frontier.empty(); ++depth) {
+        next.clear();
+        for (const std::uint32_t n : frontier) {
+            const std::uintptr_t t = nodes[n].addr;
+            const std::uint64_t lo = t > opt.maxOffset ? t - opt.maxOffset : 0;
+            const auto [b, e] = valueRange(lo, (std::uint64_t)t + 1);
+            // ближайшие к полю (с меньшим смещением) — последними в диапазоне; идём от них
+            for (std::size_t i = e; i-- > b;) {
+                const std::uintptr_t a = addr[i];
+                if (!seen.insert(a).second) continue;
+                nodes.push_back({ a, n, (std::uint32_t)(t - value[i]) });
+                const std::uint32_t id = (std::uint32_t)(nodes.size() - 1);
+                if (isStatic(a, opt.module)) {
+                    emit(id);
+                    if (chains.size() >= opt.maxResults) return chains;
+                }
+                else {
+                    next.push_back(id);
+                }
+                if (nodes.size() >= opt.maxNodes) return chains;
+            }
+        }
+        frontier.swap(next);
+    }
+    return chains;
+}
+
+bool resolve_pointer_chain(const PointerChain& chain, std::uintptr_t& out)
+{
+    std::uintptr_t a = chain.base;
+    for (const std::uint32_t off : chain.offsets) {
+        std::uint64_t v = 0;
+        if (!safe_load_u64(a, v)) return false;
+        a = (std::uintptr_t)v + off;
+    }
+    out = a;
+    return true;
+}
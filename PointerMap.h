@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+#include "AddressOracle.h"
+#include "ObjectScanner.h"
+
+// Цепочка от статического адреса к цели: addr = base; для каждого off: addr = *(addr) + off.
+// После последнего смещения addr равен цели.
+struct PointerChain {
+    std::uintptr_t base = 0;
+    std::uintptr_t module = 0; // модуль, в образе которого лежит base
+    std::vector<std::uint32_t> offsets;
+};
+
+struct PointerChainOptions {
+    unsigned maxDepth = 4;           // сколько разыменований в цепочке
+    std::uint32_t maxOffset = 0x800; // смещение поля внутри объекта на каждом уровне
+    std::size_t maxResults = 64;
+    std::size_t maxNodes = 1 << 20;  // предел обхода: на глубине 4+ дерево ссылок взрывается
+    std::uintptr_t module = 0;       // 0 — корнем считается образ любого модуля
+};
+
+// Все 8-байтовые слова выбранной памяти, значения которых указывают в читаемую память,
+// в виде «значение → адрес», отсортированные по значению (при равных — по адресу).
+// Строится одним проходом; после этого обратные запросы — двоичный поиск, без новых сканов.
+// Цена — 16 байт на найденный указатель.
+class PointerMap {
+public:
+    std::vector<std::uint64_t>  value;
+    std::vector<std::uintptr_t> addr;
+
+    std::size_t size() const { return value.size(); }
+    bool empty() const { return value.empty(); }
+    std::size_t memoryBytes() const { return value.capacity() * 8 + addr.capacity() * sizeof(std::uintptr_t); }
+
+    // Адреса, где лежит ровно v (например, все объекты с данным vptr), по возрастанию
+    std::span<const std::uintptr_t> referrers(std::uint64_t v) const;
+    // Диапазон записей [first, second) со значениями в [lo, hi) — указатели внутрь объекта
+    std::pair<std::size_t, std::size_t> valueRange(std::uint64_t lo, std::uint64_t hi) const;
+
+    // Лежит ли адрес в образе модуля (module == 0 — любого)
+    bool isStatic(std::uintptr_t a, std::uintptr_t module = 0) const;
+    // Модуль образа, в котором лежит a, или 0
+    std::uintptr_t moduleOf(std::uintptr_t a) const;
+
+    // Обход ссылок в ширину от target: кратчайшие цепочки от образов модулей, не длиннее
+    // opt.maxDepth. Каждый адрес посещается один раз, поэтому циклы не страшны.
+    std::vector<PointerChain> findChains(std::uintptr_t target, const PointerChainOptions& opt = {}) const;
+
+private:
+    friend PointerMap build_pointer_map(const ScanOptions& opt);
+    // Регионы образов, попавшие в скан, по возрастанию адреса
+    std::vector<std::uintptr_t> imageBeg, imageEnd, imageOwner;
+};
+
+// Один проход по памяти opt.policy (обычно ScanPolicy::pointerSources()). Цель указателя
+// проверяется по всей читаемой памяти провайдера, а не только по opt.policy. Учитываются
+// threads, pool, progress, chunkSize; isa и unaligned — нет: берутся выровненные слова.
+// При отмене через progress возвращается пустая карта.
+PointerMap build_pointer_map(const ScanOptions& opt);
+
+// Пройти цепочку в памяти процесса; false — где-то по пути память нечитаема
+bool resolve_pointer_chain(const PointerChain& chain, std::uintptr_t& out);
@@ -0,0 +1,165 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+
+ScanThreadStats& ScanThreadStats::operator+=(const ScanThreadStats& o)
+{
+    busySeconds += o.busySeconds;
+    chunks += o.chunks;
+    bytes += o.bytes;
+    pages += o.pages;
+    pagesReused += o.pagesReused;
+    faultPages += o.faultPages;
+    return *this;
+}
+
+double ScanProfile::utilization(std::size_t tid) const
+{
+    if (tid >= threads.size() || seconds <= 0) return 0;
+    return std::min(1.0, threads[tid].busySeconds / seconds);
+}
+
+double ScanProfile::gigabytesPerSecond() const
+{
+    return seconds > 0 ? total.bytes / seconds / 1e9 : 0;
+}
+
+const char* frame_stage_name(FrameStage s)
+{
+    switch (s) {
+    case FrameStage::Menu:    return "Menu";
+    case FrameStage::Evict:   return "Evict";
+    case FrameStage::Ingest:  return "Ingest";
+    case FrameStage::Grid:    return "Grid";
+    case FrameStage::Update:  return "Update";
+    case FrameStage::Nearby:  return "Nearby";
+    case FrameStage::Project: return "Project";
+    case FrameStage::Markers: return "Markers";
+    case FrameStage::Labels:  return "Labels";
+    case FrameStage::Render:  return "Render";
+    case FrameStage::Present: return "Present";
+    case FrameStage::Count:   break;
+    }
+    return "";
+}
+
+static float to_ms(FrameProfiler::Clock::duration d)
+{
+    return std::chrono::duration<float, std::milli>(d).count();
+}
+
+void FrameProfiler::beginFrame()
+{
+    prevStart = frameStart;
+    frameStart = Clock::now();
+    lastMark = frameStart;
+    current.fill(Clock::duration::zero());
+}
+
+void FrameProfiler::endFrame()
+{
+    ++frameNo;
+    if (paused) return;
+    // номер храним явно: кадры, пропущенные на паузе, в историю не попадают
+    numbers[head] = frameNo;
+    Row& r = history[head];
+    for (std::size_t s = 0; s < kStages; ++s) r[s] = to_ms(current[s]);
+    r[kStages] = to_ms(Clock::now() - frameStart);
+    r[kStages + 1] = prevStart == Clock::time_point{} ? 0.0f : to_ms(frameStart - prevStart);
+    head = (head + 1) % kHistory;
+    count = std::min(count + 1, kHistory);
+}
+
+FrameProfiler::Stats FrameProfiler::column(std::size_t c) const
+{
+    Stats st;
+    if (count == 0) return st;
+    double sum = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const float v = row(i)[c];
+        sum += v;
+        st.max = std::max<double>(st.max, v);
+    }
+    st.avg = sum / count;
+    st.last = row(count - 1)[c];
+    return st;
+}
+
+FrameProfiler::Stats FrameProfiler::stage(FrameStage s) const { return column((std::size_t)s); }
+FrameProfiler::Stats FrameProfiler::total() const { return column(kStages); }
+FrameProfiler::Stats FrameProfiler::interval() const { return column(kStages + 1); }
+
+std::uint64_t FrameProfiler::frameNumber(std::size_t i) const
+{
+    return numbers[(head + kHistory - count + i) % kHistory];
+}
+
+bool write_frames_csv(const std::string& path, const FrameProfiler& frames)
+{
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "frame,interval_ms,total_ms");
+    for (std::size_t s = 0; s < FrameProfiler::kStages; ++s) std::fprintf(f, ",%s_ms", frame_stage_name((FrameStage)s));
+    std::fprintf(f, "\n");
+    for (std::size_t i = 0; i < frames.frames(); ++i) {
+        std::fprintf(f, "%llu,%.4f,%.4f", (unsigned long long)frames.frameNumber(i), frames.intervalAt(i), frames.totalAt(i));
+        for (std::size_t s = 0; s < FrameProfiler::kStages; ++s) std::fprintf(f, ",%.4f", frames.stageAt(i, (FrameStage)s));
+        std::fprintf(f, "\n");
+    }
+    return std::fclose(f) == 0;
+}
+
+bool write_scans_csv(const std::string& path, std::span<const ScanProfile> scans)
+{
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "scan,incremental,seconds,bytes,gb_per_s,pages,pages_reused,fault_pages,hits,passes,threads,min_util,avg_util\n");
+    for (std::size_t i = 0; i < scans.size(); ++i) {
+        const ScanProfile& p = scans[i];
+        double minUtil = p.threads.empty() ? 0 : 1, sumUtil = 0;
+        for (std::size_t t = 0; t < p.threads.size(); ++t) {
+            minUtil = std::min(minUtil, p.utilization(t));
+            sumUtil += p.utilization(t);
+        }
+        std::fprintf(f, "%zu,%d,%.6f,%zu,%.3f,%zu,%zu,%zu,%zu,%zu,%zu,%.3f,%.3f\n", i, p.incremental ? 1 : 0,
+            p.seconds, p.total.bytes, p.gigabytesPerSecond(), p.total.pages, p.total.pagesReused,
+            p.total.faultPages, p.hits, p.passes, p.threads.size(), minUtil,
+            p.threads.empty() ? 0.0 : sumUtil / p.threads.size());
+    }
+    return std::fclose(f) == 0;
+}
+
+bool write_profile_json(const std::string& path, const FrameProfiler& frames, std::span<const ScanProfile> scans)
+{
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "{\n  \"stages\": [");
+    for (std::size_t s = 0; s < FrameProfiler::kStages; ++s) {
+        std::fprintf(f, "%s\"%s\"", s ? ", " : "", frame_stage_name((FrameStage)s));
+    }
+    // кадр — массив: номер, интервал, итог и этапы в порядке "stages"; так файл в разы короче
+    std::fprintf(f, "],\n  \"frames\": [");
+    for (std::size_t i = 0; i < frames.frames(); ++i) {
+        std::fprintf(f, "%s\n    [%llu, %.4f, %.4f", i ? "," : "", (unsigned long long)frames.frameNumber(i),
+            frames.intervalAt(i), frames.totalAt(i));
+        for (std::size_t s = 0; s < FrameProfiler::kStages; ++s) std::fprintf(f, ", %.4f", frames.stageAt(i, (FrameStage)s));
+        std::fprintf(f, "]");
+    }
+    std::fprintf(f, "\n  ],\n  \"scans\": [");
+    for (std::size_t i = 0; i < scans.size(); ++i) {
+        const ScanProfile& p = scans[i];
+        std::fprintf(f, "%s\n    {\"incremental\": %s, \"seconds\": %.6f, \"bytes\": %zu, \"pages\": %zu, "
+            "\"pagesReused\": %zu, \"faultPages\": %zu, \"hits\": %zu, \"passes\": %zu, \"threads\": [",
+            i ? "," : "", p.incremental ? "true" : "false", p.seconds, p.total.bytes, p.total.pages,
+            p.total.pagesReused, p.total.faultPages, p.hits, p.passes);
+        for (std::size_t t = 0; t < p.threads.size(); ++t) {
+            const ScanThreadStats& ts = p.threads[t];
+            std::fprintf(f, "%s{\"busySeconds\": %.6f, \"chunks\": %zu, \"bytes\": %zu, \"faultPages\": %zu}",
+                t ? ", " : "", ts.busySeconds, ts.chunks, ts.bytes, ts.faultPages);
+        }
+        std::fprintf(f, "]}");
+    }
+    std::fprintf(f, "\n  ]\n}\n");
+    return std::fclose(f) == 0;
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Счётчики одного воркера за скан
+struct ScanThreadStats {
+    double busySeconds = 0;     // время внутри чанков, без ожидания работы
+    std::size_t chunks = 0;
+    std::size_t bytes = 0;
+    std::size_t pages = 0;      // просканированные страницы
+    std::size_t pagesReused = 0; // инкрементальный скан: страницы без изменений
+    std::size_t faultPages = 0; // страницы, ушедшие в безопасный проход после исключения
+
+    ScanThreadStats& operator+=(const ScanThreadStats& o);
+};
+
+// Итог одного вызова скана (см. ScanOptions::profile). Заполняется и при отмене.
+struct ScanProfile {
+    double seconds = 0;
+    std::size_t passes = 0; // проходов по памяти: по одному на группу игл
+    std::size_t hits = 0;   // сырые находки до проверки кандидатов
+    bool incremental = false;
+    ScanThreadStats total;               // сумма по потокам
+    std::vector<ScanThreadStats> threads; // по воркеру
+
+    // Доля времени скана, которую воркер был занят
+    double utilization(std::size_t tid) const;
+    double gigabytesPerSecond() const;
+};
+
+// Этапы кадра в HookPresent
+enum class FrameStage : std::uint8_t {
+    Menu,    // новый кадр ImGui и окно настроек
+    Evict,   // сверка с картой памяти
+    Ingest,  // приём результата скана
+    Grid,    // пересборка сетки
+    Update,  // план UpdateScheduler и чтение выбранных
+    Nearby,  // выборка ячеек у камеры, фильтр
+    Project,
+    Markers,
+    Labels,
+    Render,  // ImGui::Render и отрисовка DX11
+    Present, // оригинальный Present игры
+    Count
+};
+
+const char* frame_stage_name(FrameStage s);
+
+// Время этапов последних кадров. Только поток рендера, без блокировок: add() — одно сложение.
+class FrameProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::size_t kStages = (std::size_t)FrameStage::Count;
+    static constexpr std::size_t kHistory = 300; // около 5 секунд при 60 FPS
+
+    struct Stats {
+        double last = 0, avg = 0, max = 0; // миллисекунды по истории
+    };
+
+    void beginFrame();
+    void endFrame();
+    void add(FrameStage s, Clock::duration d) { current[(std::size_t)s] += d; }
+    // Время с прошлой отметки (или с начала кадра) уходит в этап s — для линейного кода кадра,
+    // где ProfileScope пришлось бы заводить вложенными блоками
+    void lap(FrameStage s)
+    {
+        const Clock::time_point now = Clock::now();
+        current[(std::size_t)s] += now - lastMark;
+        lastMark = now;
+    }
+
+    // Пауза замораживает историю, чтобы разглядеть или выгрузить всплеск
+    void setPaused(bool value) { paused = value; }
+    bool isPaused() const { return paused; }
+
+    std::size_t frames() const { return count; }
+    Stats stage(FrameStage s) const;
+    Stats total() const;    // от beginFrame до endFrame
+    Stats interval() const; // между соседними beginFrame — время кадра игры
+
+    // Кадр i истории, от старого к новому: номер, время этапов, итог, интервал (мс)
+    std::uint64_t frameNumber(std::size_t i) const;
+    float stageAt(std::size_t i, FrameStage s) const { return row(i)[(std::size_t)s]; }
+    float totalAt(std::size_t i) const { return row(i)[kStages]; }
+    float intervalAt(std::size_t i) const { return row(i)[kStages + 1]; }
+
+private:
+    using Row = std::array<float, kStages + 2>;
+    const Row& row(std::size_t i) const { return history[(head + kHistory - count + i) % kHistory]; }
+    Stats column(std::size_t c) const;
+
+    std::array<Clock::duration, kStages> current{};
+    Clock::time_point frameStart{}, prevStart{}, lastMark{};
+    std::array<Row, kHistory> history{};
+    std::array<std::uint64_t, kHistory> numbers{};
+    std::size_t head = 0, count = 0;
+    std::uint64_t frameNo = 0;
+    bool paused = false;
+};
+
+// Замер области: время уходит в этап при выходе из области
+class ProfileScope {
+public:
+    ProfileScope(FrameProfiler& p, FrameStage s) : profiler(p), stage(s), start(FrameProfiler::Clock::now()) {}
+    ~ProfileScope() { profiler.add(stage, FrameProfiler::Clock::now() - start); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    FrameProfiler& profiler;
+    FrameStage stage;
+    FrameProfiler::Clock::time_point start;
+};
+
+// Выгрузка для разбора вне игры. CSV — по строке на кадр или на скан; JSON — всё вместе.
+bool write_frames_csv(const std::string& path, const FrameProfiler& frames);
+bool write_scans_csv(const std::string& path, std::span<const ScanProfile> scans);
+bool write_profile_json(const std::string& path, const FrameProfiler& frames, std::span<const ScanProfile> scans);
@@ -0,0 +1,180 @@
+#include "Projector.h"
+
+#include <bit>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static inline unsigned lowest_bit(unsigned mask)
+{
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward(&i, mask);
+    return (unsigned)i;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+// Всё, что нужно ядрам, в float и без повторных вычислений на каждую точку
+struct BatchParams {
+    float cx, cy, cz;
+    float r[3][3];
+    float maxD2, invMaxD;
+    float halfW, halfH, sx, ky, W, H;
+};
+
+static BatchParams batch_params(const Projector& p, const Vec3& cam, const Mat3& R, float maxDistance)
+{
+    BatchParams b;
+    b.cx = cam.x; b.cy = cam.y; b.cz = cam.z;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j) b.r[i][j] = R.m[i][j];
+    b.maxD2 = maxDistance * maxDistance;
+    b.invMaxD = maxDistance > 0.0f ? 1.0f / maxDistance : 0.0f;
+    b.halfW = p.halfW; b.halfH = p.halfH;
+    b.sx = p.signX * p.kx; b.ky = p.ky;
+    b.W = (float)p.W; b.H = (float)p.H;
+    return b;
+}
+
+static inline void emit(ProjectedPoints& out, std::size_t i, float u, float v, float d2, const BatchParams& b)
+{
+    const std::size_t k = out.count++;
+    out.index[k] = (std::uint32_t)i;
+    out.u[k] = u;
+    out.v[k] = v;
+    out.norm[k] = std::sqrt(d2) * b.invMaxD;
+}
+
+static void project_scalar(const BatchParams& b, const float* x, const float* y, const float* z,
+    std::size_t i, std::size_t n, ProjectedPoints& out)
+{
+    for (; i < n; ++i) {
+        const float dx = x[i] - b.cx, dy = y[i] - b.cy, dz = z[i] - b.cz;
+        const float d2 = dx * dx + dy * dy + dz * dz;
+        if (!(d2 <= b.maxD2)) continue;
+        const float cx = b.r[0][0] * dx + b.r[0][1] * dy + b.r[0][2] * dz;
+        if (!(cx > 0.0f)) continue;
+        const float cy = b.r[1][0] * dx + b.r[1][1] * dy + b.r[1][2] * dz;
+        const float cz = b.r[2][0] * dx + b.r[2][1] * dy + b.r[2][2] * dz;
+        const float u = b.halfW + b.sx * (cy / cx);
+        const float v = b.halfH - b.ky * (cz / cx);
+        if (u >= 0.0f && u <= b.W && v >= 0.0f && v <= b.H) emit(out, i, u, v, d2, b);
+    }
+}
+
+// Сравнения упорядоченные (_OQ): NaN из мусорной памяти не проходит ни одну проверку,
+// как и в скалярной версии. Без FMA, чтобы округление совпадало со скалярным путём.
+ISA_TARGET("avx2")
+static void project_avx2(const BatchParams& b, const float* x, const float* y, const float* z,
+    std::size_t n, ProjectedPoints& out)
+{
+    const __m256 camx = _mm256_set1_ps(b.cx), camy = _mm256_set1_ps(b.cy), camz = _mm256_set1_ps(b.cz);
+    const __m256 r00 = _mm256_set1_ps(b.r[0][0]), r01 = _mm256_set1_ps(b.r[0][1]), r02 = _mm256_set1_ps(b.r[0][2]);
+    const __m256 r10 = _mm256_set1_ps(b.r[1][0]), r11 = _mm256_set1_ps(b.r[1][1]), r12 = _mm256_set1_ps(b.r[1][2]);
+    const __m256 r20 = _mm256_set1_ps(b.r[2][0]), r21 = _mm256_set1_ps(b.r[2][1]), r22 = _mm256_set1_ps(b.r[2][2]);
+    const __m256 maxD2 = _mm256_set1_ps(b.maxD2), zero = _mm256_setzero_ps();
+    const __m256 halfW = _mm256_set1_ps(b.halfW), halfH = _mm256_set1_ps(b.halfH);
+    const __m256 sx = _mm256_set1_ps(b.sx), ky = _mm256_set1_ps(b.ky);
+    const __m256 W = _mm256_set1_ps(b.W), H = _mm256_set1_ps(b.H);
+
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), camx);
+        const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), camy);
+        const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(z + i), camz);
+        const __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+        const __m256 cx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r00, dx), _mm256_mul_ps(r01, dy)), _mm256_mul_ps(r02, dz));
+        __m256 ok = _mm256_and_ps(_mm256_cmp_ps(d2, maxD2, _CMP_LE_OQ), _mm256_cmp_ps(cx, zero, _CMP_GT_OQ));
+        if (_mm256_movemask_ps(ok) == 0) continue;
+
+        const __m256 cy = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r10, dx), _mm256_mul_ps(r11, dy)), _mm256_mul_ps(r12, dz));
+        const __m256 cz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r20, dx), _mm256_mul_ps(r21, dy)), _mm256_mul_ps(r22, dz));
+        const __m256 u = _mm256_add_ps(halfW, _mm256_mul_ps(sx, _mm256_div_ps(cy, cx)));
+        const __m256 v = _mm256_sub_ps(halfH, _mm256_mul_ps(ky, _mm256_div_ps(cz, cx)));
+        ok = _mm256_and_ps(ok, _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(u, W, _CMP_LE_OQ)));
+        ok = _mm256_and_ps(ok, _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ), _mm256_cmp_ps(v, H, _CMP_LE_OQ)));
+        unsigned m = (unsigned)_mm256_movemask_ps(ok);
+        if (m == 0) continue;
+
+        alignas(32) float su[8], sv[8], sd[8];
+        _mm256_store_ps(su, u);
+        _mm256_store_ps(sv, v);
+        _mm256_store_ps(sd, d2);
+        while (m) {
+            const unsigned lane = lowest_bit(m);
+            m &= m - 1;
+            emit(out, i + lane, su[lane], sv[lane], sd[lane], b);
+        }
+    }
+    project_scalar(b, x, y, z, i, n, out);
+}
+
+// Видимые точки сразу упаковываются compress-store в выходные массивы
+ISA_TARGET("avx512f")
+static void project_avx512(const BatchParams& b, const float* x, const float* y, const float* z,
+    std::size_t n, ProjectedPoints& out)
+{
+    const __m512 camx = _mm512_set1_ps(b.cx), camy = _mm512_set1_ps(b.cy), camz = _mm512_set1_ps(b.cz);
+    const __m512 r00 = _mm512_set1_ps(b.r[0][0]), r01 = _mm512_set1_ps(b.r[0][1]), r02 = _mm512_set1_ps(b.r[0][2]);
+    const __m512 r10 = _mm512_set1_ps(b.r[1][0]), r11 = _mm512_set1_ps(b.r[1][1]), r12 = _mm512_set1_ps(b.r[1][2]);
+    const __m512 r20 = _mm512_set1_ps(b.r[2][0]), r21 = _mm512_set1_ps(b.r[2][1]), r22 = _mm512_set1_ps(b.r[2][2]);
+    const __m512 maxD2 = _mm512_set1_ps(b.maxD2), zero = _mm512_setzero_ps();
+    const __m512 halfW = _mm512_set1_ps(b.halfW), halfH = _mm512_set1_ps(b.halfH);
+    const __m512 sx = _mm512_set1_ps(b.sx), ky = _mm512_set1_ps(b.ky);
+    const __m512 W = _mm512_set1_ps(b.W), H = _mm512_set1_ps(b.H);
+    const __m512 invMaxD = _mm512_set1_ps(b.invMaxD);
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512 dx = _mm512_sub_ps(_mm512_loadu_ps(x + i), camx);
+        const __m512 dy = _mm512_sub_ps(_mm512_loadu_ps(y + i), camy);
+        const __m512 dz = _mm512_sub_ps(_mm512_loadu_ps(z + i), camz);
+        const __m512 d2 = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy)), _mm512_mul_ps(dz, dz));
+        const __m512 cx = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(r00, dx), _mm512_mul_ps(r01, dy)), _mm512_mul_ps(r02, dz));
+        __mmask16 ok = _mm512_cmp_ps_mask(d2, maxD2, _CMP_LE_OQ) & _mm512_cmp_ps_mask(cx, zero, _CMP_GT_OQ);
+        if (ok == 0) continue;
+
+        const __m512 cy = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(r10, dx), _mm512_mul_ps(r11, dy)), _mm512_mul_ps(r12, dz));
+        const __m512 cz = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(r20, dx), _mm512_mul_ps(r21, dy)), _mm512_mul_ps(r22, dz));
+        const __m512 u = _mm512_add_ps(halfW, _mm512_mul_ps(sx, _mm512_div_ps(cy, cx)));
+        const __m512 v = _mm512_sub_ps(halfH, _mm512_mul_ps(ky, _mm512_div_ps(cz, cx)));
+        ok &= _mm512_cmp_ps_mask(u, zero, _CMP_GE_OQ) & _mm512_cmp_ps_mask(u, W, _CMP_LE_OQ);
+        ok &= _mm512_cmp_ps_mask(v, zero, _CMP_GE_OQ) & _mm512_cmp_ps_mask(v, H, _CMP_LE_OQ);
+        if (ok == 0) continue;
+
+        const std::size_t k = out.count;
+        const __m512i idx = _mm512_add_epi32(_mm512_set1_epi32((int)i), lanes);
+        _mm512_mask_compressstoreu_epi32(out.index.data() + k, ok, idx);
+        _mm512_mask_compressstoreu_ps(out.u.data() + k, ok, u);
+        _mm512_mask_compressstoreu_ps(out.v.data() + k, ok, v);
+        _mm512_mask_compressstoreu_ps(out.norm.data() + k, ok, _mm512_mul_ps(_mm512_sqrt_ps(d2), invMaxD));
+        out.count = k + (std::size_t)std::popcount((unsigned)ok);
+    }
+    project_scalar(b, x, y, z, i, n, out);
+}
+
+std::size_t project_batch(const Projector& proj, const float* x, const float* y, const float* z,
+    std::size_t n, const Vec3& cam, const Mat3& R, float maxDistance, ProjectedPoints& out,
+    ScanIsa isa)
+{
+    // ядра пишут по индексу, поэтому места должно хватать на все точки сразу
+    if (out.index.size() < n) {
+        out.index.resize(n);
+        out.u.resize(n);
+        out.v.resize(n);
+        out.norm.resize(n);
+    }
+    out.count = 0;
+
+    const BatchParams b = batch_params(proj, cam, R, maxDistance);
+    switch (resolve_scan_isa(isa)) {
+    case ScanIsa::AVX512: project_avx512(b, x, y, z, n, out); break;
+    case ScanIsa::AVX2:   project_avx2(b, x, y, z, n, out); break;
+    default:              project_scalar(b, x, y, z, 0, n, out); break;
+    }
+    return out.count;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CpuFeatures.h"
+
+struct Vec3 {
+    float x, y, z;
+};
+struct Mat3 { float m[3][3]; };
+
+
+inline float Distance(const Vec3& a, const Vec3& b)
+{
+    float dx = a.x - b.x;
+    float dy = a.y - b.y;
+    float dz = a.z - b.z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+struct Projector {
+    int W, H;
+    float halfW, halfH;
+    float kx, ky;
+    float signX;
+    Projector(int w, int h, float fov, bool right_is_negative = true)
+        : W(w), H(h), halfW(w * 0.5f), halfH(h * 0.5f), signX(right_is_negative ? -1.0f : 1.0f)
+    {
+        constexpr double pi = 3.14159265358979323846;
+        const double aspect = double(W) / double(H);
+        const double Fh = fov * pi / 180.0;
+        const double Fv = 2.0 * std::atan(std::tan(Fh * 0.5) / aspect);
+        kx = float(halfW / std::tan(Fh * 0.5));
+        ky = float(halfH / std::tan(Fv * 0.5));
+    }
+
+    // Возвращает false, если точка за спиной/вне экрана
+    inline bool project(const Vec3& X_world, const Vec3& C_cam, const Mat3& R,
+        float& u, float &v) const noexcept
+    {
+        const Vec3 d = { X_world.x - C_cam.x, X_world.y - C_cam.y, X_world.z - C_cam.z };
+        const float cx = R.m[0][0] * d.x + R.m[0][1] * d.y + R.m[0][2] * d.z;
+        if (!(cx > 0.0f)) return false;
+        const float cy = R.m[1][0] * d.x + R.m[1][1] * d.y + R.m[1][2] * d.z;
+        const float cz = R.m[2][0] * d.x + R.m[2][1] * d.y + R.m[2][2] * d.z;
+        u = halfW + signX * kx * (cy / cx);
+        v = halfH - ky * (cz / cx);
+        return (u >= 0.0f && u <= W && v >= 0.0f && v <= H);
+    }
+};
+
+// Результат project_batch: первые count элементов — видимые точки в порядке входа.
+// Векторы только растут, так что кадр за кадром память не перевыделяется.
+struct ProjectedPoints {
+    std::size_t count = 0;
+    std::vector<std::uint32_t> index; // индекс точки во входных массивах
+    std::vector<float> u, v;          // экранные координаты
+    std::vector<float> norm;          // расстояние / maxDistance, 0..1
+};
+
+// Проекция n точек из массивов x/y/z: отсев по maxDistance (по квадрату, без sqrt для
+// отброшенных), поворот в систему камеры, перспективное деление и проверка попадания
+// на экран — по 8 (AVX2) или 16 (AVX-512) точек за итерацию. Результат совпадает с
+// последовательными Distance + project. Возвращает out.count.
+std::size_t project_batch(const Projector& proj, const float* x, const float* y, const float* z,
+    std::size_t n, const Vec3& cam, const Mat3& R, float maxDistance, ProjectedPoints& out,
+    ScanIsa isa = ScanIsa::Auto);
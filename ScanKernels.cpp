@@ -0,0 +1,292 @@
+#include "ScanKernels.h"
+
+#include <cstring>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static inline unsigned lowest_bit(unsigned mask)
+{
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward(&i, mask);
+    return (unsigned)i;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+static inline unsigned lowest_bit64(std::uint64_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward64(&i, mask);
+    return (unsigned)i;
+#else
+    return (unsigned)__builtin_ctzll(mask);
+#endif
+}
+
+void scan_block_scalar_aligned(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, std::size_t,
+    HitBuckets& out)
+{
+    for (; p + 8 <= pend; p += 8) {
+        push_hit(ns, *reinterpret_cast<const std::uint64_t*>(p), p, out);
+    }
+}
+
+// В SSE2 нет сравнения 64-битных слов: сравниваем половинки и требуем совпадения обеих
+static inline __m128i cmpeq_epi64_sse2(__m128i a, __m128i b)
+{
+    const __m128i eq32 = _mm_cmpeq_epi32(a, b);
+    return _mm_and_si128(eq32, _mm_shuffle_epi32(eq32, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+void scan_block_sse2_aligned(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, std::size_t,
+    HitBuckets& out)
+{
+    __m128i pat[NeedleSet::kMax];
+    for (std::size_t k = 0; k < ns.n; ++k) pat[k] = _mm_set1_epi64x((long long)ns.v[k]);
+
+    // два регистра за итерацию — те же 32 байта, что и у AVX2
+    for (; p + 32 <= pend; p += 32) {
+        const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+        __m128i e0 = cmpeq_epi64_sse2(v0, pat[0]);
+        __m128i e1 = cmpeq_epi64_sse2(v1, pat[0]);
+        for (std::size_t k = 1; k < ns.n; ++k) {
+            e0 = _mm_or_si128(e0, cmpeq_epi64_sse2(v0, pat[k]));
+            e1 = _mm_or_si128(e1, cmpeq_epi64_sse2(v1, pat[k]));
+        }
+        const int mask = _mm_movemask_pd(_mm_castsi128_pd(e0)) | (_mm_movemask_pd(_mm_castsi128_pd(e1)) << 2);
+        if (mask) {
+            const std::uint64_t* q = reinterpret_cast<const std::uint64_t*>(p);
+            if (mask & 0x1) push_hit(ns, q[0], p + 0, out);
+            if (mask & 0x2) push_hit(ns, q[1], p + 8, out);
+            if (mask & 0x4) push_hit(ns, q[2], p + 16, out);
+            if (mask & 0x8) push_hit(ns, q[3], p + 24, out);
+        }
+    }
+    // хвост
+    scan_block_scalar_aligned(p, pend, ns, 0, out);
+}
+
+ISA_TARGET("avx2")
+void scan_block_avx2_aligned(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, std::size_t ps,
+    HitBuckets& out)
+{
+    __m256i pat[NeedleSet::kMax];
+    for (std::size_t k = 0; k < ns.n; ++k) pat[k] = _mm256_set1_epi64x((long long)ns.v[k]);
+
+    // основной цикл по 32 байта: блок сравнивается со всеми иглами сразу
+    for (; p + 32 <= pend; p += 32) {
+        // PREFETCH безопасен, но чтобы не волноваться — подстрахуемся по границе страницы
+        if ((p & (ps - 1)) == 0) {
+            _mm_prefetch(reinterpret_cast<const char*>(p + 256), _MM_HINT_T0);
+        }
+
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i eq = _mm256_cmpeq_epi64(v, pat[0]);
+        for (std::size_t k = 1; k < ns.n; ++k) {
+            eq = _mm256_or_si256(eq, _mm256_cmpeq_epi64(v, pat[k]));
+        }
+        const int mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+        if (mask) {
+            // редкий случай: разбираем, какая именно игла совпала
+            const std::uint64_t* q = reinterpret_cast<const std::uint64_t*>(p);
+            if (mask & 0x1) push_hit(ns, q[0], p + 0, out);
+            if (mask & 0x2) push_hit(ns, q[1], p + 8, out);
+            if (mask & 0x4) push_hit(ns, q[2], p + 16, out);
+            if (mask & 0x8) push_hit(ns, q[3], p + 24, out);
+        }
+    }
+    // хвост
+    scan_block_scalar_aligned(p, pend, ns, ps, out);
+}
+
+ISA_TARGET("avx512f")
+void scan_block_avx512_aligned(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, std::size_t ps,
+    HitBuckets& out)
+{
+    __m512i pat[NeedleSet::kMax];
+    for (std::size_t k = 0; k < ns.n; ++k) pat[k] = _mm512_set1_epi64((long long)ns.v[k]);
+
+    // 64 байта за итерацию; совпадения сразу приходят маской, без movemask
+    for (; p + 64 <= pend; p += 64) {
+        if ((p & (ps - 1)) == 0) {
+            _mm_prefetch(reinterpret_cast<const char*>(p + 256), _MM_HINT_T0);
+        }
+
+        const __m512i v = _mm512_loadu_si512(reinterpret_cast<const void*>(p));
+        __mmask8 mask = _mm512_cmpeq_epi64_mask(v, pat[0]);
+        for (std::size_t k = 1; k < ns.n; ++k) {
+            mask = (__mmask8)(mask | _mm512_cmpeq_epi64_mask(v, pat[k]));
+        }
+        unsigned m = mask;
+        while (m) {
+            const unsigned lane = lowest_bit(m);
+            m &= m - 1;
+            push_hit(ns, reinterpret_cast<const std::uint64_t*>(p)[lane], p + lane * 8, out);
+        }
+    }
+    // хвост
+    scan_block_scalar_aligned(p, pend, ns, ps, out);
+}
+
+AlignedBlockKernel aligned_block_kernel(ScanIsa isa)
+{
+    switch (resolve_scan_isa(isa)) {
+    case ScanIsa::AVX512: return scan_block_avx512_aligned;
+    case ScanIsa::AVX2:   return scan_block_avx2_aligned;
+    case ScanIsa::SSE2:   return scan_block_sse2_aligned;
+    default:              return scan_block_scalar_aligned;
+    }
+}
+
+// --- невыровненные ---
+
+void scan_block_scalar_unaligned(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, HitBuckets& out)
+{
+    for (; p + 8 <= pend; ++p) {
+        std::uint64_t v;
+        std::memcpy(&v, reinterpret_cast<const void*>(p), 8);
+        push_hit(ns, v, p, out);
+    }
+}
+
+// Опорные байты иглы для префильтра. В кучах больше всего нулей (старшие байты
+// указателей, пустые поля), потом FF; младший байт указателя часто выровнен и повторяется,
+// поэтому при равенстве предпочитаем средние байты.
+struct NeedleAnchors {
+    unsigned off1[NeedleSet::kMax], off2[NeedleSet::kMax];
+    std::uint8_t b1[NeedleSet::kMax], b2[NeedleSet::kMax];
+};
+
+static int byte_commonness(std::uint8_t b)
+{
+    if (b == 0x00) return 3;
+    if (b == 0xFF) return 2;
+    if (b == 0x7F || b == 0x01) return 1;
+    return 0;
+}
+
+static NeedleAnchors needle_anchors(const NeedleSet& ns)
+{
+    static constexpr unsigned kOrder[8] = { 2, 3, 1, 4, 0, 5, 6, 7 };
+    NeedleAnchors a{};
+    for (std::size_t k = 0; k < ns.n; ++k) {
+        std::uint8_t bytes[8];
+        std::memcpy(bytes, &ns.v[k], 8);
+        unsigned first = 8, second = 8;
+        for (const unsigned i : kOrder) {
+            if (first == 8 || byte_commonness(bytes[i]) < byte_commonness(bytes[first])) {
+                second = first;
+                first = i;
+            }
+            else if (second == 8 || byte_commonness(bytes[i]) < byte_commonness(bytes[second])) {
+                second = i;
+            }
+        }
+        a.off1[k] = first;
+        a.off2[k] = second;
+        a.b1[k] = bytes[first];
+        a.b2[k] = bytes[second];
+    }
+    return a;
+}
+
+static inline void verify_unaligned(std::uintptr_t p, std::uint64_t m, const NeedleSet& ns, HitBuckets& out)
+{
+    while (m) {
+        const unsigned j = lowest_bit64(m);
+        m &= m - 1;
+        std::uint64_t v;
+        std::memcpy(&v, reinterpret_cast<const void*>(p + j), 8);
+        push_hit(ns, v, p + j, out);
+    }
+}
+
+void scan_block_sse2_unaligned(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, HitBuckets& out)
+{
+    const NeedleAnchors a = needle_anchors(ns);
+    __m128i b1[NeedleSet::kMax], b2[NeedleSet::kMax];
+    for (std::size_t k = 0; k < ns.n; ++k) {
+        b1[k] = _mm_set1_epi8((char)a.b1[k]);
+        b2[k] = _mm_set1_epi8((char)a.b2[k]);
+    }
+
+    // 16 начал за итерацию; последнему нужны ещё 7 байт после блока
+    for (; p + 16 + 7 <= pend; p += 16) {
+        unsigned m = 0;
+        for (std::size_t k = 0; k < ns.n; ++k) {
+            const __m128i e1 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + a.off1[k])), b1[k]);
+            const __m128i e2 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + a.off2[k])), b2[k]);
+            m |= (unsigned)_mm_movemask_epi8(_mm_and_si128(e1, e2));
+        }
+        if (m) verify_unaligned(p, m, ns, out);
+    }
+    scan_block_scalar_unaligned(p, pend, ns, out);
+}
+
+ISA_TARGET("avx2")
+void scan_block_avx2_unaligned(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, HitBuckets& out)
+{
+    const NeedleAnchors a = needle_anchors(ns);
+    __m256i b1[NeedleSet::kMax], b2[NeedleSet::kMax];
+    for (std::size_t k = 0; k < ns.n; ++k) {
+        b1[k] = _mm256_set1_epi8((char)a.b1[k]);
+        b2[k] = _mm256_set1_epi8((char)a.b2[k]);
+    }
+
+    for (; p + 32 + 7 <= pend; p += 32) {
+        unsigned m = 0;
+        for (std::size_t k = 0; k < ns.n; ++k) {
+            const __m256i e1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + a.off1[k])), b1[k]);
+            const __m256i e2 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + a.off2[k])), b2[k]);
+            m |= (unsigned)_mm256_movemask_epi8(_mm256_and_si256(e1, e2));
+        }
+        if (m) verify_unaligned(p, m, ns, out);
+    }
+    scan_block_scalar_unaligned(p, pend, ns, out);
+}
+
+ISA_TARGET("avx512f,avx512bw")
+void scan_block_avx512_unaligned(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, HitBuckets& out)
+{
+    const NeedleAnchors a = needle_anchors(ns);
+    __m512i b1[NeedleSet::kMax], b2[NeedleSet::kMax];
+    for (std::size_t k = 0; k < ns.n; ++k) {
+        b1[k] = _mm512_set1_epi8((char)a.b1[k]);
+        b2[k] = _mm512_set1_epi8((char)a.b2[k]);
+    }
+
+    for (; p + 64 + 7 <= pend; p += 64) {
+        std::uint64_t m = 0;
+        for (std::size_t k = 0; k < ns.n; ++k) {
+            const __m512i v1 = _mm512_loadu_si512(reinterpret_cast<const void*>(p + a.off1[k]));
+            const __m512i v2 = _mm512_loadu_si512(reinterpret_cast<const void*>(p + a.off2[k]));
+            m |= _mm512_cmpeq_epi8_mask(v1, b1[k]) & _mm512_cmpeq_epi8_mask(v2, b2[k]);
+        }
+        if (m) verify_unaligned(p, m, ns, out);
+    }
+    scan_block_scalar_unaligned(p, pend, ns, out);
+}
+
+UnalignedBlockKernel unaligned_block_kernel(ScanIsa isa)
+{
+    switch (resolve_scan_isa(isa)) {
+    case ScanIsa::AVX512: return scan_block_avx512_unaligned;
+    case ScanIsa::AVX2:   return scan_block_avx2_unaligned;
+    case ScanIsa::SSE2:   return scan_block_sse2_unaligned;
+    default:              return scan_block_scalar_unaligned;
+    }
+}
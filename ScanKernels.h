@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CpuFeatures.h"
+
+// Набор искомых значений для одного прохода. Находки раскладываются по корзинам:
+// out[k] — адреса, где лежит needles.v[k].
+struct NeedleSet {
+    static constexpr std::size_t kMax = 8;
+    std::uint64_t v[kMax] = {};
+    std::size_t   n = 0;
+};
+using HitBuckets = std::vector<std::vector<std::uintptr_t>>;
+
+static inline void push_hit(const NeedleSet& ns, std::uint64_t value, std::uintptr_t p, HitBuckets& out)
+{
+    for (std::size_t k = 0; k < ns.n; ++k) {
+        if (value == ns.v[k]) { out[k].push_back(p); return; }
+    }
+}
+
+// Выровненный по 8 байт проход по [p, pend) без защиты от сбоев — вызывать под guarded().
+// ps — размер страницы (для подсказок предвыборки).
+using AlignedBlockKernel = void (*)(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, std::size_t ps, HitBuckets& out);
+
+void scan_block_scalar_aligned(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, std::size_t ps, HitBuckets& out);
+void scan_block_sse2_aligned(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, std::size_t ps, HitBuckets& out);
+void scan_block_avx2_aligned(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, std::size_t ps, HitBuckets& out);
+void scan_block_avx512_aligned(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, std::size_t ps, HitBuckets& out);
+
+// Ядро для набора инструкций; isa проходит через resolve_scan_isa, так что
+// запрос недоступного набора не приведёт к недопустимой инструкции
+AlignedBlockKernel aligned_block_kernel(ScanIsa isa);
+
+// Невыровненный проход: проверяются все начала s в [p, pend - 8], без защиты от сбоев.
+// Векторные версии сравнивают по байтам два самых редких байта каждой иглы сразу для
+// 16/32/64 позиций и читают 8 байт только там, где оба совпали.
+using UnalignedBlockKernel = void (*)(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, HitBuckets& out);
+
+void scan_block_scalar_unaligned(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, HitBuckets& out);
+void scan_block_sse2_unaligned(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, HitBuckets& out);
+void scan_block_avx2_unaligned(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, HitBuckets& out);
+void scan_block_avx512_unaligned(std::uintptr_t p, std::uintptr_t pend,
+    const NeedleSet& ns, HitBuckets& out);
+
+UnalignedBlockKernel unaligned_block_kernel(ScanIsa isa);
@@ -0,0 +1,126 @@
+#include "ScanThreadPool.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+int current_cpu()
+{
+#ifdef _WIN32
+    return (int)GetCurrentProcessorNumber();
+#else
+    return sched_getcpu();
+#endif
+}
+
+// Привязка текущего потока к маске процессоров (0 — без привязки, ничего не делаем)
+static void apply_affinity(std::uint64_t mask)
+{
+    if (mask == 0) return;
+#ifdef _WIN32
+    SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)mask);
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned i = 0; i < 64; ++i) {
+        if (mask & (1ull << i)) CPU_SET(i, &set);
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+static std::uint64_t all_cpus_mask()
+{
+    const unsigned n = std::thread::hardware_concurrency();
+    return n >= 64 ? ~0ull : ((1ull << n) - 1);
+}
+
+ScanThreadPool::ScanThreadPool(const ThreadPoolConfig& cfg)
+    : config(cfg)
+{
+    unsigned n = cfg.threads;
+    if (n == 0) {
+        const unsigned hw = std::thread::hardware_concurrency();
+        n = hw > 1 ? hw - 1 : 1;
+    }
+    buffers.resize(n);
+    arenas.resize(n);
+    workers.reserve(n);
+    for (unsigned t = 0; t < n; ++t) workers.emplace_back(&ScanThreadPool::workerLoop, this, t);
+}
+
+ScanThreadPool::~ScanThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lk(m);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& th : workers) th.join();
+}
+
+std::uint64_t ScanThreadPool::effectiveMask() const
+{
+    std::uint64_t mask = config.affinityMask;
+    if (reservedCore < 0 || reservedCore >= 64) return mask;
+
+    // Исключаем ядро рендера; если исключать нечего или не остаётся ни одного ядра — оставляем как есть
+    const std::uint64_t base = mask ? mask : all_cpus_mask();
+    const std::uint64_t reduced = base & ~(1ull << reservedCore);
+    return reduced ? reduced : mask;
+}
+
+void ScanThreadPool::run(unsigned nt, const std::function<void(unsigned)>& fn)
+{
+    if (nt > size()) nt = size();
+    if (nt == 0) return;
+
+    std::lock_guard<std::mutex> serial(runMutex);
+    // явно заданное ядро (см. setReservedCore) важнее ядра вызывающего потока
+    if (config.avoidCallerCore && !reservedExplicit) reservedCore = current_cpu();
+
+    std::unique_lock<std::mutex> lk(m);
+    job = &fn;
+    active = nt;
+    pending = nt;
+    jobMask = effectiveMask();
+    ++generation;
+    wake.notify_all();
+    done.wait(lk, [&] { return pending == 0; });
+    job = nullptr;
+}
+
+void ScanThreadPool::workerLoop(unsigned tid)
+{
+    std::uint64_t seen = 0;
+    std::uint64_t appliedMask = 0;
+    for (;;) {
+        const std::function<void(unsigned)>* fn = nullptr;
+        std::uint64_t mask = 0;
+        {
+            std::unique_lock<std::mutex> lk(m);
+            wake.wait(lk, [&] { return stopping || (generation != seen && tid < active); });
+            if (stopping) return;
+            seen = generation;
+            fn = job;
+            mask = jobMask;
+        }
+
+        // маску меняем только когда она действительно поменялась: это системный вызов
+        if (mask != appliedMask) {
+            apply_affinity(mask ? mask : all_cpus_mask());
+            appliedMask = mask;
+        }
+
+        (*fn)(tid);
+
+        std::lock_guard<std::mutex> lk(m);
+        if (--pending == 0) done.notify_one();
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ThreadPoolConfig {
+    unsigned threads = 0;            // 0 — hardware_concurrency() - 1, одно ядро остаётся игре
+    std::uint64_t affinityMask = 0;  // 0 — без привязки; иначе бит i — логический процессор i
+    bool avoidCallerCore = true;     // не занимать ядро потока, запустившего задачу (поток рендера)
+};
+
+// Долгоживущий пул воркеров для сканера. Потоки спят на condition_variable между сканами,
+// буферы находок каждого воркера переиспользуются от скана к скану.
+class ScanThreadPool {
+public:
+    explicit ScanThreadPool(const ThreadPoolConfig& cfg = {});
+    ~ScanThreadPool();
+
+    ScanThreadPool(const ScanThreadPool&) = delete;
+    ScanThreadPool& operator=(const ScanThreadPool&) = delete;
+
+    unsigned size() const { return (unsigned)workers.size(); }
+
+    // Выполняет job(tid) на первых nt воркерах (nt <= size()) и ждёт завершения всех.
+    // Вызовы из разных потоков выполняются по очереди, каждый целиком.
+    void run(unsigned nt, const std::function<void(unsigned)>& job);
+
+    // Буферы находок воркера tid: по вектору на иглу. Живут всё время жизни пула.
+    std::vector<std::vector<std::uintptr_t>>& hitBuffers(unsigned tid) { return buffers[tid]; }
+    // Арена воркера под блоки отложенных находок потокового скана
+    std::vector<std::uintptr_t>& blockArena(unsigned tid) { return arenas[tid]; }
+
+    // Ядро, которое воркеры должны обходить, вместо ядра вызывающего run() потока
+    // (-1 — вернуться к поведению из конфигурации)
+    void setReservedCore(int cpu) { reservedCore = cpu; reservedExplicit = cpu >= 0; }
+
+private:
+    void workerLoop(unsigned tid);
+    std::uint64_t effectiveMask() const;
+
+    ThreadPoolConfig config;
+    std::vector<std::thread> workers;
+    std::vector<std::vector<std::vector<std::uintptr_t>>> buffers;
+    std::vector<std::vector<std::uintptr_t>> arenas;
+
+    std::mutex runMutex; // держится всё время run(): одна задача на пул
+    std::mutex m;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(unsigned)>* job = nullptr;
+    std::uint64_t generation = 0;
+    std::uint64_t jobMask = 0;
+    unsigned active = 0;
+    unsigned pending = 0;
+    int reservedCore = -1;
+    bool reservedExplicit = false;
+    bool stopping = false;
+};
+
+// Номер логического процессора, на котором сейчас выполняется вызывающий поток
+int current_cpu();
@@ -0,0 +1,303 @@
+#include "SignatureScanner.h"
+#include "IncrementalScan.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <immintrin.h>
+#include <sstream>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static inline unsigned lowest_bit(unsigned mask)
+{
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward(&i, mask);
+    return (unsigned)i;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+static int hex_digit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool parse_signature(std::string_view text, Signature& out)
+{
+    out.bytes.clear();
+    out.mask.clear();
+    bool any = false;
+    std::size_t i = 0;
+    while (i < text.size()) {
+        const char c = text[i];
+        if (c == ' ' || c == '\t') { ++i; continue; }
+        if (c == '?') {
+            i += (i + 1 < text.size() && text[i + 1] == '?') ? 2 : 1;
+            out.bytes.push_back(0);
+            out.mask.push_back(0);
+            continue;
+        }
+        if (i + 1 >= text.size()) return false;
+        const int hi = hex_digit(c), lo = hex_digit(text[i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        out.bytes.push_back((std::uint8_t)(hi * 16 + lo));
+        out.mask.push_back(1);
+        any = true;
+        i += 2;
+    }
+    return any;
+}
+
+// Грубая оценка частоты байта в x64-коде: префиксы REX, mov/lea/call, ModRM с rsp/rbp,
+// нули и FF встречаются постоянно — по ним префильтр почти ничего не отсеет
+static int byte_commonness(std::uint8_t b)
+{
+    switch (b) {
+    case 0x00: case 0xFF: case 0xCC: return 100;
+    case 0x48: case 0x8B: case 0x89: case 0x24: case 0x44: case 0x4C: return 80;
+    case 0x0F: case 0xE8: case 0x8D: case 0x83: case 0xC0: case 0x01: case 0x45:
+    case 0x85: case 0x74: case 0x75: case 0x41: case 0x49: case 0x90: case 0xC3:
+    case 0x33: case 0xD2: case 0xEB: case 0x20: case 0x10: case 0x08: case 0x28:
+    case 0x30: case 0x38: case 0x40: case 0x50: case 0x58: case 0x60: case 0x18: return 50;
+    default: return 0;
+    }
+}
+
+// Два опорных байта префильтра: самый редкий и следующий за ним (в другой позиции)
+static void pick_anchors(const Signature& sig, std::size_t& a1, std::size_t& a2)
+{
+    a1 = a2 = sig.size();
+    for (std::size_t i = 0; i < sig.size(); ++i) {
+        if (!sig.mask[i]) continue;
+        if (a1 == sig.size() || byte_commonness(sig.bytes[i]) < byte_commonness(sig.bytes[a1])) {
+            a2 = a1;
+            a1 = i;
+        }
+        else if (a2 == sig.size() || byte_commonness(sig.bytes[i]) < byte_commonness(sig.bytes[a2])) {
+            a2 = i;
+        }
+    }
+    if (a2 == sig.size()) a2 = a1; // в шаблоне один значимый байт
+}
+
+static inline bool matches_at(const std::uint8_t* p, const Signature& sig)
+{
+    for (std::size_t i = 0; i < sig.size(); ++i) {
+        if (sig.mask[i] && p[i] != sig.bytes[i]) return false;
+    }
+    return true;
+}
+
+// Позиции [from, last] — кандидаты начала совпадения
+static void find_scalar(const std::uint8_t* p, std::size_t from, std::size_t last, const Signature& sig,
+    std::size_t a1, std::size_t a2, std::size_t maxHits, std::vector<std::uintptr_t>& out)
+{
+    for (std::size_t i = from; i <= last && out.size() < maxHits; ++i) {
+        if (p[i + a1] == sig.bytes[a1] && p[i + a2] == sig.bytes[a2] && matches_at(p + i, sig)) {
+            out.push_back(reinterpret_cast<std::uintptr_t>(p + i));
+        }
+    }
+}
+
+static void find_sse2(const std::uint8_t* p, std::size_t last, const Signature& sig,
+    std::size_t a1, std::size_t a2, std::size_t maxHits, std::vector<std::uintptr_t>& out)
+{
+    const __m128i b1 = _mm_set1_epi8((char)sig.bytes[a1]);
+    const __m128i b2 = _mm_set1_epi8((char)sig.bytes[a2]);
+    std::size_t i = 0;
+    for (; i + 15 <= last && out.size() < maxHits; i += 16) {
+        const __m128i e1 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + a1)), b1);
+        const __m128i e2 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + a2)), b2);
+        unsigned m = (unsigned)_mm_movemask_epi8(_mm_and_si128(e1, e2));
+        while (m && out.size() < maxHits) {
+            const unsigned k = lowest_bit(m);
+            m &= m - 1;
+            if (matches_at(p + i + k, sig)) out.push_back(reinterpret_cast<std::uintptr_t>(p + i + k));
+        }
+    }
+    find_scalar(p, i, last, sig, a1, a2, maxHits, out);
+}
+
+ISA_TARGET("avx2")
+static void find_avx2(const std::uint8_t* p, std::size_t last, const Signature& sig,
+    std::size_t a1, std::size_t a2, std::size_t maxHits, std::vector<std::uintptr_t>& out)
+{
+    const __m256i b1 = _mm256_set1_epi8((char)sig.bytes[a1]);
+    const __m256i b2 = _mm256_set1_epi8((char)sig.bytes[a2]);
+    std::size_t i = 0;
+    for (; i + 31 <= last && out.size() < maxHits; i += 32) {
+        const __m256i e1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + a1)), b1);
+        const __m256i e2 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + a2)), b2);
+        unsigned m = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(e1, e2));
+        while (m && out.size() < maxHits) {
+            const unsigned k = lowest_bit(m);
+            m &= m - 1;
+            if (matches_at(p + i + k, sig)) out.push_back(reinterpret_cast<std::uintptr_t>(p + i + k));
+        }
+    }
+    find_scalar(p, i, last, sig, a1, a2, maxHits, out);
+}
+
+std::vector<std::uintptr_t> find_signature(const std::uint8_t* p, std::size_t n, const Signature& sig,
+    std::size_t maxHits, ScanIsa isa)
+{
+    std::vector<std::uintptr_t> out;
+    if (sig.size() == 0 || n < sig.size() || maxHits == 0) return out;
+
+    std::size_t a1, a2;
+    pick_anchors(sig, a1, a2);
+    if (a1 == sig.size()) return out; // одни пропуски
+
+    const std::size_t last = n - sig.size(); // последняя возможная позиция начала
+    switch (resolve_scan_isa(isa)) {
+    case ScanIsa::AVX512: // байтовые сравнения AVX-512 требуют BW; AVX2 здесь упирается в память
+    case ScanIsa::AVX2:   find_avx2(p, last, sig, a1, a2, maxHits, out); break;
+    case ScanIsa::SSE2:   find_sse2(p, last, sig, a1, a2, maxHits, out); break;
+    default:              find_scalar(p, 0, last, sig, a1, a2, maxHits, out); break;
+    }
+    return out;
+}
+
+// --- правила ---
+
+static std::string trim(std::string_view s)
+{
+    const auto b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string_view::npos) return {};
+    const auto e = s.find_last_not_of(" \t\r\n");
+    return std::string(s.substr(b, e - b + 1));
+}
+
+std::vector<SignatureRule> load_signature_rules(const std::string& path)
+{
+    std::vector<SignatureRule> rules;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        const std::string l = trim(line);
+        if (l.empty() || l[0] == '#') continue;
+        const auto eq = l.find('='), semi = l.find(';');
+        if (eq == std::string::npos || semi == std::string::npos || semi < eq) continue;
+
+        SignatureRule r;
+        r.name = trim(std::string_view(l).substr(0, eq));
+        if (r.name.empty() || !parse_signature(trim(std::string_view(l).substr(eq + 1, semi - eq - 1)), r.sig)) continue;
+
+        std::istringstream op(l.substr(semi + 1));
+        std::string kind;
+        op >> kind;
+        if (kind == "match") {
+            r.kind = SignatureKind::Match;
+            op >> r.offset;
+        }
+        else if (kind == "rip") {
+            r.kind = SignatureKind::Rip;
+            if (!(op >> r.offset >> r.dispOffset >> r.instrLength)) continue;
+            op >> r.add;
+        }
+        else {
+            continue;
+        }
+        rules.push_back(std::move(r));
+    }
+    return rules;
+}
+
+std::uint64_t module_hash(std::uintptr_t moduleBase)
+{
+    return page_fingerprint(moduleBase, 4096);
+}
+
+// Правила тоже входят в ключ кэша: поправили шаблон — кэш недействителен
+static std::uint64_t rules_hash(const std::vector<SignatureRule>& rules)
+{
+    std::uint64_t h = 0xCBF29CE484222325ull;
+    auto mix = [&](const void* p, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) h = (h ^ static_cast<const std::uint8_t*>(p)[i]) * 0x100000001B3ull;
+        };
+    for (const auto& r : rules) {
+        mix(r.name.data(), r.name.size());
+        mix(r.sig.bytes.data(), r.sig.size());
+        mix(r.sig.mask.data(), r.sig.size());
+        const std::int64_t params[] = { (std::int64_t)r.kind, r.offset, r.dispOffset, r.instrLength, r.add };
+        mix(params, sizeof(params));
+    }
+    return h;
+}
+
+static bool load_cache(const std::string& path, std::uint64_t key1, std::uint64_t key2,
+    std::unordered_map<std::string, std::uintptr_t>& out)
+{
+    std::ifstream in(path);
+    std::string tag1, tag2;
+    std::uint64_t k1 = 0, k2 = 0;
+    if (!(in >> tag1 >> std::hex >> k1 >> tag2 >> k2) || tag1 != "module" || tag2 != "rules") return false;
+    if (k1 != key1 || k2 != key2) return false;
+    std::string name;
+    std::uint64_t rva = 0;
+    while (in >> name >> rva) out[name] = (std::uintptr_t)rva;
+    return true;
+}
+
+static void save_cache(const std::string& path, std::uint64_t key1, std::uint64_t key2,
+    const std::unordered_map<std::string, std::uintptr_t>& rvas)
+{
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return;
+    std::fprintf(f, "module %016" PRIx64 " rules %016" PRIx64 "\n", key1, key2);
+    for (const auto& [name, rva] : rvas) std::fprintf(f, "%s %" PRIx64 "\n", name.c_str(), (std::uint64_t)rva);
+    std::fclose(f);
+}
+
+std::unordered_map<std::string, std::uintptr_t> resolve_signatures(const std::vector<SignatureRule>& rules,
+    std::uintptr_t moduleBase, const std::string& cachePath, const RegionProvider& provider)
+{
+    std::unordered_map<std::string, std::uintptr_t> rvas;
+    if (rules.empty() || moduleBase == 0) return rvas;
+
+    const std::uint64_t mod = module_hash(moduleBase), rh = rules_hash(rules);
+    if (!cachePath.empty() && load_cache(cachePath, mod, rh, rvas)) return rvas;
+
+    // исполняемые регионы образа; соседние склеиваются, чтобы шаблон мог лежать на стыке
+    ScanPolicy policy;
+    policy.types = TypeImage;
+    policy.requireProtect = ProtRead | ProtExec;
+    policy.onlyModules = { moduleBase };
+    std::vector<std::pair<std::uintptr_t, std::uintptr_t>> code;
+    for (const Region& r : apply_scan_policy(provider.enumerate(), policy)) {
+        const auto b = reinterpret_cast<std::uintptr_t>(r.base);
+        if (!code.empty() && code.back().second == b) code.back().second = b + r.size;
+        else code.emplace_back(b, b + r.size);
+    }
+
+    for (const SignatureRule& rule : rules) {
+        // два совпадения — шаблон неоднозначен, третье искать незачем
+        std::vector<std::uintptr_t> hits;
+        for (const auto& [b, e] : code) {
+            auto h = find_signature(reinterpret_cast<const std::uint8_t*>(b), e - b, rule.sig, 2 - hits.size());
+            hits.insert(hits.end(), h.begin(), h.end());
+            if (hits.size() >= 2) break;
+        }
+        if (hits.size() != 1) continue;
+
+        std::uintptr_t target = hits[0] + rule.offset;
+        if (rule.kind == SignatureKind::Rip) {
+            std::int32_t disp;
+            std::memcpy(&disp, reinterpret_cast<const void*>(target + rule.dispOffset), sizeof(disp));
+            target = target + rule.instrLength + disp + rule.add;
+        }
+        rvas[rule.name] = target - moduleBase;
+    }
+
+    if (!cachePath.empty()) save_cache(cachePath, mod, rh, rvas);
+    return rvas;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "CpuFeatures.h"
+#include "MemoryRegions.h"
+
+// Шаблон байтов с пропусками: mask[i] == 0 — байт i может быть любым
+struct Signature {
+    std::vector<std::uint8_t> bytes;
+    std::vector<std::uint8_t> mask;
+    std::size_t size() const { return bytes.size(); }
+};
+
+// Разбор строки в стиле IDA: "48 8B 05 ?? ?? ?? ?? 48 85 C0" ("?" тоже пропуск).
+// false — пустой шаблон, мусор в строке или шаблон из одних пропусков.
+bool parse_signature(std::string_view text, Signature& out);
+
+// Все вхождения sig в [p, p + n) по возрастанию адреса, не больше maxHits. SIMD-префильтр
+// сравнивает сразу 16/32 позиции по двум самым редким для x64-кода байтам шаблона,
+// полная проверка — только для прошедших префильтр. Чтение не защищено.
+std::vector<std::uintptr_t> find_signature(const std::uint8_t* p, std::size_t n, const Signature& sig,
+    std::size_t maxHits = 16, ScanIsa isa = ScanIsa::Auto);
+
+// Как из найденного места получить адрес
+enum class SignatureKind {
+    Match, // адрес самого совпадения + offset
+    Rip    // операнд RIP-относительной инструкции, начинающейся в совпадении + offset
+};
+
+// Правило из файла сигнатур. Одна строка:
+//   name = <шаблон> ; match [offset]
+//   name = <шаблон> ; rip <offset> <dispOffset> <instrLength> [add]
+// Для rip: инструкция начинается в match + offset, 32-битное смещение лежит в ней по
+// dispOffset, цель = начало + instrLength + disp + add. Строки с # — комментарии.
+struct SignatureRule {
+    std::string name;
+    Signature sig;
+    SignatureKind kind = SignatureKind::Match;
+    std::int64_t offset = 0;
+    std::int64_t dispOffset = 0;
+    std::int64_t instrLength = 0;
+    std::int64_t add = 0;
+};
+
+// Разбор файла правил; кривые строки пропускаются. Нет файла — пустой список.
+std::vector<SignatureRule> load_signature_rules(const std::string& path);
+
+// Отпечаток модуля для ключа кэша: хэш страницы заголовков (в PE там метка времени
+// сборки и размер образа — меняются с каждым патчем)
+std::uint64_t module_hash(std::uintptr_t moduleBase);
+
+// RVA по имени для каждого правила, однозначно найденного в исполняемых регионах модуля.
+// Правило, давшее 0 или больше одного совпадения, в результат не попадает.
+// cachePath непуст — результаты читаются из кэша, если он записан для того же module_hash,
+// и записываются туда после скана.
+std::unordered_map<std::string, std::uintptr_t> resolve_signatures(const std::vector<SignatureRule>& rules,
+    std::uintptr_t moduleBase, const std::string& cachePath = {},
+    const RegionProvider& provider = default_region_provider());
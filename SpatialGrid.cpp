@@ -0,0 +1,92 @@
+#include "SpatialGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Координата ячейки; NaN и выбросы из мусорной памяти прижимаются к краю, а не ломают хэш
+static inline std::int64_t cell_coord(float v, float inv)
+{
+    const float c = std::floor(v * inv);
+    if (!(c > -1e9f)) return -1000000000;
+    if (c > 1e9f) return 1000000000;
+    return (std::int64_t)c;
+}
+
+std::uint32_t SpatialGrid::bucket(std::int64_t ix, std::int64_t iy, std::int64_t iz) const
+{
+    const std::uint64_t h = (std::uint64_t)ix * 0x9E3779B185EBCA87ull
+        ^ (std::uint64_t)iy * 0xC2B2AE3D27D4EB4Full
+        ^ (std::uint64_t)iz * 0x165667B19E3779F9ull;
+    return (std::uint32_t)((h ^ (h >> 32)) & mask);
+}
+
+std::uint32_t SpatialGrid::bucketOf(float x, float y, float z) const
+{
+    return bucket(cell_coord(x, inv), cell_coord(y, inv), cell_coord(z, inv));
+}
+
+void SpatialGrid::build(const float* x, const float* y, const float* z, std::size_t n, float cellSize)
+{
+    cell = cellSize > 0.0f ? cellSize : 1.0f;
+    inv = 1.0f / cell;
+
+    // корзин — степень двойки не меньше n: в среднем по объекту на корзину
+    std::uint32_t buckets = 64;
+    while (buckets < n) buckets <<= 1;
+    mask = buckets - 1;
+
+    key.resize(n);
+    start.assign(buckets + 1, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        key[i] = bucketOf(x[i], y[i], z[i]);
+        ++start[key[i] + 1];
+    }
+    for (std::uint32_t b = 0; b < buckets; ++b) start[b + 1] += start[b];
+
+    items.resize(n);
+    std::vector<std::uint32_t> fill(start.begin(), start.end() - 1);
+    for (std::size_t i = 0; i < n; ++i) items[fill[key[i]]++] = (std::uint32_t)i;
+
+    stamp.assign(buckets, 0);
+    epoch = 0;
+}
+
+void SpatialGrid::query(const Vec3& c, float r, std::vector<std::uint32_t>& out) const
+{
+    if (items.empty()) return;
+
+    const std::int64_t x0 = cell_coord(c.x - r, inv), x1 = cell_coord(c.x + r, inv);
+    const std::int64_t y0 = cell_coord(c.y - r, inv), y1 = cell_coord(c.y + r, inv);
+    const std::int64_t z0 = cell_coord(c.z - r, inv), z1 = cell_coord(c.z + r, inv);
+
+    // сфера накрывает больше ячеек, чем корзин в таблице — проще отдать всё
+    const double cells = double(x1 - x0 + 1) * double(y1 - y0 + 1) * double(z1 - z0 + 1);
+    if (cells >= double(stamp.size())) {
+        out.insert(out.end(), items.begin(), items.end());
+        return;
+    }
+
+    // разные ячейки могут попасть в одну корзину: отметки не дают выдать её дважды
+    if (++epoch == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        epoch = 1;
+    }
+    for (std::int64_t ix = x0; ix <= x1; ++ix)
+        for (std::int64_t iy = y0; iy <= y1; ++iy)
+            for (std::int64_t iz = z0; iz <= z1; ++iz) {
+                const std::uint32_t b = bucket(ix, iy, iz);
+                if (stamp[b] == epoch) continue;
+                stamp[b] = epoch;
+                out.insert(out.end(), items.begin() + start[b], items.begin() + start[b + 1]);
+            }
+}
+
+std::size_t SpatialGrid::moved(const float* x, const float* y, const float* z,
+    std::span<const std::uint32_t> idx) const
+{
+    std::size_t n = 0;
+    for (const std::uint32_t i : idx) {
+        if (i < key.size() && bucketOf(x[i], y[i], z[i]) != key[i]) ++n;
+    }
+    return n;
+}
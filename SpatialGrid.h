@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Projector.h"
+
+// Равномерная сетка над позициями объектов с хэшированием ячеек: мир не ограничен,
+// а таблица занимает O(n). Строится подсчётом за два прохода по уже прочитанным
+// позициям, так что перестройка не трогает память игры.
+class SpatialGrid {
+public:
+    // Разложить n точек по ячейкам со стороной cellSize
+    void build(const float* x, const float* y, const float* z, std::size_t n, float cellSize);
+
+    // Кандидаты в сфере (c, r): все объекты из ячеек, которые она задевает, без повторов.
+    // Точный отсев по расстоянию — дело вызывающего (см. project_batch).
+    void query(const Vec3& c, float r, std::vector<std::uint32_t>& out) const;
+
+    // Сколько из объектов idx переехало в другую корзину с момента build() —
+    // ненулевой результат значит, что сетку пора перестроить
+    std::size_t moved(const float* x, const float* y, const float* z,
+        std::span<const std::uint32_t> idx) const;
+
+    float cellSize() const { return cell; }
+    std::size_t size() const { return key.size(); }
+
+private:
+    std::uint32_t bucketOf(float x, float y, float z) const;
+    std::uint32_t bucket(std::int64_t ix, std::int64_t iy, std::int64_t iz) const;
+
+    float cell = 0.0f, inv = 0.0f;
+    std::uint32_t mask = 0;
+    std::vector<std::uint32_t> start; // начало корзины b в items: start[b]..start[b+1]
+    std::vector<std::uint32_t> items; // индексы объектов, сгруппированные по корзинам
+    std::vector<std::uint32_t> key;   // корзина каждого объекта на момент build()
+    mutable std::vector<std::uint32_t> stamp; // отметки посещённых корзин в query()
+    mutable std::uint32_t epoch = 0;
+};
@@ -0,0 +1,95 @@
+#include "UpdateScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+void UpdateScheduler::plan(EntityTable& table, std::span<const std::uint32_t> nearby, const Projector& proj,
+    const Vec3& cam, const Mat3& R, float maxDistance, std::vector<std::uint32_t>& out)
+{
+    ++frameNo;
+    out.clear();
+    last = {};
+    nearDue.clear();
+    midDue.clear();
+    midVisible.resize(table.size());
+    nearbyMark.resize(table.size());
+
+    const std::size_t budget = tiers.readBudget;
+    const float nearSq = tiers.nearRadius * tiers.nearRadius;
+    const float maxSq = maxDistance * maxDistance;
+    // границы экрана в тангенсах: |cy| * kx <= limX * cx, как в Projector::project
+    const float limX = proj.halfW * (1.0f + 2.0f * tiers.screenMargin);
+    const float limY = proj.halfH * (1.0f + 2.0f * tiers.screenMargin);
+
+    for (const std::uint32_t i : nearby) {
+        nearbyMark[i] = frameNo;
+        if (table.dead[i]) continue;
+        const Vec3 d = { table.x[i] - cam.x, table.y[i] - cam.y, table.z[i] - cam.z };
+        const float distSq = d.x * d.x + d.y * d.y + d.z * d.z;
+        if (distSq < nearSq) {
+            nearDue.push_back({ distSq, i });
+            continue;
+        }
+        const float cx = R.m[0][0] * d.x + R.m[0][1] * d.y + R.m[0][2] * d.z;
+        const float cy = R.m[1][0] * d.x + R.m[1][1] * d.y + R.m[1][2] * d.z;
+        const float cz = R.m[2][0] * d.x + R.m[2][1] * d.y + R.m[2][2] * d.z;
+        const bool onScreen = distSq <= maxSq && cx > 0.0f &&
+            std::fabs(cy) * proj.kx <= limX * cx && std::fabs(cz) * proj.ky <= limY * cx;
+        const unsigned interval = std::max(1u, onScreen ? tiers.visibleInterval : tiers.offscreenInterval);
+        const std::uint32_t age = frameNo - table.readFrame[i];
+        if (age < interval) continue;
+        midDue.push_back({ -(float)age / (float)interval, i });
+        midVisible[i] = onScreen;
+    }
+
+    // Ближние — всегда; если их больше бюджета, то ближайшие
+    if (nearDue.size() > budget) {
+        std::nth_element(nearDue.begin(), nearDue.begin() + budget, nearDue.end(),
+            [](const Due& a, const Due& b) { return a.rank < b.rank; });
+        last.deferred += nearDue.size() - budget;
+        nearDue.resize(budget);
+    }
+    for (const Due& e : nearDue) {
+        table.readFrame[e.index] = frameNo;
+        out.push_back(e.index);
+    }
+    last.near = out.size();
+
+    // Дальним — своя доля, иначе плотная толпа у камеры никогда не отпустит бюджет
+    takeFar(table, std::min(tiers.farShare, budget - out.size()), out);
+
+    // Средние — самые просроченные первыми
+    std::size_t take = std::min(midDue.size(), budget - out.size());
+    if (take < midDue.size()) {
+        std::nth_element(midDue.begin(), midDue.begin() + take, midDue.end(),
+            [](const Due& a, const Due& b) { return a.rank < b.rank; });
+        last.deferred += midDue.size() - take;
+    }
+    for (std::size_t k = 0; k < take; ++k) {
+        const std::uint32_t i = midDue[k].index;
+        table.readFrame[i] = frameNo;
+        out.push_back(i);
+        ++(midVisible[i] ? last.visible : last.offscreen);
+    }
+
+    // Остаток бюджета — снова дальним
+    takeFar(table, budget - out.size(), out);
+}
+
+void UpdateScheduler::takeFar(EntityTable& table, std::size_t limit, std::vector<std::uint32_t>& out)
+{
+    const std::size_t n = table.size();
+    const unsigned interval = std::max(1u, tiers.farInterval);
+    // за вызов обходим таблицу не больше одного раза: readFrame — плотный массив в нашей памяти,
+    // так что дорого здесь только само чтение объекта. Записи из ячеек у камеры — не дальние:
+    // их срок считает plan(), и взятая здесь попала бы в out второй раз
+    for (std::size_t seen = 0; seen < n && limit > 0; ++seen) {
+        if (cursor >= n) cursor = 0;
+        const std::uint32_t i = (std::uint32_t)cursor++;
+        if (table.dead[i] || nearbyMark[i] == frameNo || frameNo - table.readFrame[i] < interval) continue;
+        table.readFrame[i] = frameNo;
+        out.push_back(i);
+        ++last.far;
+        --limit;
+    }
+}
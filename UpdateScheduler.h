@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "EntityTable.h"
+#include "Projector.h"
+
+// Как часто перечитывать объект в зависимости от того, где он относительно камеры.
+// Интервалы в кадрах; между чтениями в таблице остаются последние прочитанные значения.
+struct UpdateTiers {
+    float nearRadius = 20.0f;       // ближе — каждый кадр, в обход очереди
+    unsigned visibleInterval = 2;   // в кадре и в пределах maxDistance
+    unsigned offscreenInterval = 8; // за спиной, сбоку от экрана или чуть дальше maxDistance
+    unsigned farInterval = 60;      // вне ячеек у камеры — только заметить переехавших
+    std::size_t readBudget = 1024;  // объектов за кадр, включая ближних
+    std::size_t farShare = 64;      // часть бюджета, которую дальние получают всегда
+    float screenMargin = 0.1f;      // запас к краям экрана, доля ширины/высоты
+};
+
+// Выбор записей EntityTable, которые читаются из памяти игры в этом кадре. Стоимость кадра
+// ограничена readBudget независимо от числа объектов: ближние берутся всегда, остальные
+// должники — по степени просрочки, дальние — по кругу. Момент выбора пишется в readFrame.
+class UpdateScheduler {
+public:
+    struct Stats {
+        std::size_t near = 0, visible = 0, offscreen = 0, far = 0;
+        std::size_t deferred = 0; // подошёл срок, но бюджет кончился
+    };
+
+    UpdateTiers tiers;
+
+    // nearby — записи из ячеек у камеры (SpatialGrid::query); остальные считаются дальними.
+    // out перезаписывается индексами для EntityTable::refresh(idx, ...).
+    void plan(EntityTable& table, std::span<const std::uint32_t> nearby, const Projector& proj,
+        const Vec3& cam, const Mat3& R, float maxDistance, std::vector<std::uint32_t>& out);
+
+    const Stats& stats() const { return last; }
+    std::uint32_t frame() const { return frameNo; }
+
+private:
+    struct Due {
+        float rank; // у ближних — квадрат расстояния, у остальных — минус степень просрочки
+        std::uint32_t index;
+    };
+
+    void takeFar(EntityTable& table, std::size_t limit, std::vector<std::uint32_t>& out);
+
+    std::vector<Due> nearDue, midDue;
+    std::vector<std::uint8_t> midVisible; // по midDue: в кадре ли объект, для статистики
+    std::vector<std::uint32_t> nearbyMark; // по записи: кадр, в котором она была в nearby
+    Stats last;
+    std::uint32_t frameNo = 0;
+    std::size_t cursor = 0; // круговой обход дальних
+};
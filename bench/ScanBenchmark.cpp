@@ -0,0 +1,406 @@
+// Замеры сканера на синтетической памяти (только Linux).
+//
+//   ScanBenchmark [--size MB] [--region KB] [--density hits/MB] [--misaligned percent]
+//                 [--holes N] [--reps N] [--threads N]
+//   ScanBenchmark --snapshot PATH [--needle HEX]... [--reps N] [--threads N]
+//
+// Строится «адресное пространство» из регионов заданного размера со случайным содержимым,
+// в него подсаживаются искомые значения с заданной плотностью (часть — по невыровненным
+// адресам), в части регионов страницы закрываются PROT_NONE — сканер видит их в карте,
+// но при чтении получает сбой и уходит на защищённый путь. Для каждого ядра и числа
+// потоков печатаются GB/s, находки в секунду и ускорение относительно одного потока.
+//
+// С --snapshot вместо синтетики сканируется снимок памяти игры (MemorySnapshot.h),
+// отображённый по исходным адресам. Иглы — встроенные vtable классов от базы модуля из
+// снимка или заданные --needle. Все ядра должны дать одинаковые находки; после скана
+// кандидаты проходят верификатор, печатается разбивка отказов.
+
+#include "CandidateVerifier.h"
+#include "CpuFeatures.h"
+#include "EntityTable.h"
+#include "MemoryRegions.h"
+#include "MemorySnapshot.h"
+#include "ObjectScanner.h"
+#include "Projector.h"
+#include "ScanThreadPool.h"
+#include "SpatialGrid.h"
+#include "UpdateScheduler.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+struct BenchConfig {
+    std::size_t totalMB = 512;
+    std::size_t regionKB = 4096;
+    double density = 4.0;     // находок на мегабайт
+    double misaligned = 10.0; // процент невыровненных
+    std::size_t holes = 8;    // регионов с закрытой страницей
+    int reps = 3;
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    std::string snapshot;              // непусто — прогон по снимку вместо синтетики
+    std::vector<std::uint64_t> needles; // иглы для снимка; пусто — встроенные vtable
+};
+
+// Карта синтетической памяти в том виде, в каком её отдал бы LinuxRegionProvider
+class SyntheticRegions : public RegionProvider {
+public:
+    std::vector<Region> regions;
+    std::vector<Region> enumerate() const override { return regions; }
+    std::size_t pageSize() const override { return (std::size_t)sysconf(_SC_PAGESIZE); }
+};
+
+struct SyntheticHeap {
+    SyntheticRegions map;
+    std::uint64_t needle = 0x00007FF6DEAD1230ull;
+    std::size_t alignedHits = 0;   // видны любому ядру
+    std::size_t misalignedHits = 0; // только невыровненному
+    std::size_t seamHits = 0;       // из misalignedHits: поперёк границы чанков скана
+    std::size_t holeBytes = 0;
+
+    ~SyntheticHeap()
+    {
+        for (const Region& r : map.regions) munmap(r.base, r.size);
+    }
+};
+
+static bool build_heap(const BenchConfig& cfg, SyntheticHeap& heap)
+{
+    const std::size_t ps = heap.map.pageSize();
+    const std::size_t regionSize = std::max(ps, cfg.regionKB * 1024 / ps * ps);
+    const std::size_t count = std::max<std::size_t>(1, cfg.totalMB * 1024 * 1024 / regionSize);
+    std::mt19937_64 rng(12345);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        void* p = mmap(nullptr, regionSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return false;
+        auto* q = static_cast<std::uint64_t*>(p);
+        // значения похожи на указатели, но никогда не равны игле
+        for (std::size_t k = 0; k < regionSize / 8; ++k) q[k] = (rng() & 0x00007FFFFFFFFFF0ull) | 1;
+        heap.map.regions.push_back({ static_cast<std::uint8_t*>(p), regionSize, ProtRead | ProtWrite });
+    }
+
+    // иглы: равномерно по всему объёму, не через границу страницы (её перешагивает только
+    // неровный хвост, который сканер не видит по определению)
+    const std::size_t total = count * regionSize;
+    const std::size_t hits = (std::size_t)(cfg.density * total / (1024.0 * 1024.0));
+    std::uniform_int_distribution<std::size_t> where(0, total / 8 - 2);
+    std::uniform_real_distribution<double> coin(0.0, 100.0);
+    std::vector<std::uint8_t> hole(count, 0);
+    std::vector<std::size_t> holePage(count, 0);
+    std::vector<std::uint8_t> used(total / 8, 0);
+    for (std::size_t i = 0; i < cfg.holes && i < count; ++i) {
+        const std::size_t r = (i * 7919) % count;
+        hole[r] = 1;
+        holePage[r] = (regionSize / ps) / 2;
+    }
+
+    for (std::size_t h = 0; h < hits; ++h) {
+        const std::size_t off = where(rng) * 8;
+        const std::size_t r = off / regionSize, in = off % regionSize;
+        const bool mis = coin(rng) < cfg.misaligned;
+        const std::size_t at = mis ? in + 3 : in;
+        if (at / ps != (at + 7) / ps) continue;
+        if (hole[r] && at / ps == holePage[r]) continue;
+        std::uint8_t* base = heap.map.regions[r].base;
+        // невыровненная игла занимает два слова: не даём ей задеть уже посаженные
+        const std::size_t w = off / 8;
+        if (used[w] || (mis && used[w + 1])) continue;
+        used[w] = 1;
+        if (mis) used[w + 1] = 1;
+        std::memcpy(base + at, &heap.needle, 8);
+        ++(mis ? heap.misalignedHits : heap.alignedHits);
+    }
+
+    // По невыровненной игле поперёк первой границы чанков внутри каждого региона: начало
+    // в одном чанке, хвост в соседнем
+    const std::size_t chunk = ScanOptions{}.chunkSize;
+    for (std::size_t r = 0; r < count; ++r) {
+        const auto b = reinterpret_cast<std::uintptr_t>(heap.map.regions[r].base);
+        const std::uintptr_t seam = (b / chunk + 1) * chunk;
+        if (seam + 8 > b + regionSize) continue;
+        const std::size_t at = seam - 3 - b;
+        if (hole[r] && (at / ps == holePage[r] || (at + 7) / ps == holePage[r])) continue;
+        const std::size_t w = (r * regionSize + at) / 8;
+        if (used[w] || used[w + 1]) continue;
+        used[w] = used[w + 1] = 1;
+        std::memcpy(heap.map.regions[r].base + at, &heap.needle, 8);
+        ++heap.misalignedHits;
+        ++heap.seamHits;
+    }
+
+    for (std::size_t r = 0; r < count; ++r) {
+        if (!hole[r]) continue;
+        mprotect(heap.map.regions[r].base + holePage[r] * ps, ps, PROT_NONE);
+        heap.holeBytes += ps;
+    }
+    return true;
+}
+
+struct Measure {
+    double seconds = 0;
+    std::size_t hits = 0;
+};
+
+static Measure run_scan(const SyntheticHeap& heap, ScanIsa isa, bool unaligned, unsigned threads,
+    ScanThreadPool& pool, int reps)
+{
+    ScanOptions opt;
+    opt.regions = &heap.map;
+    opt.policy = ScanPolicy::everything();
+    opt.isa = isa;
+    opt.unaligned = unaligned;
+    opt.threads = threads;
+    opt.pool = &pool;
+
+    Measure best;
+    best.seconds = 1e30;
+    for (int i = 0; i < reps; ++i) {
+        const auto t0 = std::chrono::steady_clock::now();
+        // считаем находки прямо в потоке: замер не включает сборку списка
+        std::size_t hits = 0;
+        scan_self_for_pointers_stream(std::span<const std::uint64_t>(&heap.needle, 1),
+            [&](std::size_t, std::span<const std::uintptr_t> block) { hits += block.size(); }, opt);
+        const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if (s < best.seconds) best = { s, hits };
+    }
+    return best;
+}
+
+static bool parse_args(int argc, char** argv, BenchConfig& cfg)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        if (i + 1 >= argc) return false;
+        const char* v = argv[++i];
+        if (a == "--size") cfg.totalMB = std::strtoull(v, nullptr, 10);
+        else if (a == "--region") cfg.regionKB = std::strtoull(v, nullptr, 10);
+        else if (a == "--density") cfg.density = std::strtod(v, nullptr);
+        else if (a == "--misaligned") cfg.misaligned = std::strtod(v, nullptr);
+        else if (a == "--holes") cfg.holes = std::strtoull(v, nullptr, 10);
+        else if (a == "--reps") cfg.reps = std::max(1, std::atoi(v));
+        else if (a == "--threads") cfg.maxThreads = std::max(1, std::atoi(v));
+        else if (a == "--snapshot") cfg.snapshot = v;
+        else if (a == "--needle") cfg.needles.push_back(std::strtoull(v, nullptr, 16));
+        else return false;
+    }
+    return true;
+}
+
+struct Kernel { const char* name; ScanIsa isa; bool unaligned; };
+static const Kernel kKernels[] = {
+    { "scalar",    ScanIsa::Scalar, false },
+    { "sse2",      ScanIsa::SSE2,   false },
+    { "avx2",      ScanIsa::AVX2,   false },
+    { "avx512",    ScanIsa::AVX512, false },
+    { "u-scalar",  ScanIsa::Scalar, true  },
+    { "u-sse2",    ScanIsa::SSE2,   true  },
+    { "u-avx2",    ScanIsa::AVX2,   true  },
+    { "u-avx512",  ScanIsa::AVX512, true  },
+};
+
+// Прогон по снимку: скорость каждого ядра, согласие ядер между собой и итог верификатора
+static double ms_since(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Кадровый конвейер оверлея по принятым кандидатам, как в main.cpp: добавление в EntityTable,
+// полный refresh, затем кадры с сеткой, UpdateScheduler, refresh по плану и project_batch.
+// Камера перескакивает от объекта к объекту, чтобы у камеры всё время была чья-то толпа.
+static void run_entity_pipeline(const std::vector<std::vector<std::uintptr_t>>& accepted,
+    const std::vector<Region>& regions, std::uint64_t deadVptr, const VerifyOptions& vo)
+{
+    constexpr int kFrames = 600;
+    const float maxDistance = 80.0f;
+    const ReadableMap readable = make_readable_map(regions);
+    NameTable names;
+    EntityTable entities;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (std::size_t k = 0; k < accepted.size(); ++k) {
+        entities.append(accepted[k], (std::uint8_t)k, vo.nameOffset, names);
+    }
+    const double appendMs = ms_since(t0);
+    t0 = std::chrono::steady_clock::now();
+    const std::size_t removed = entities.refresh(deadVptr, vo.positionOffset, &readable);
+    const double refreshMs = ms_since(t0);
+    std::printf("\nentities: %zu (%zu names, %zu dead); append %.3f ms, full refresh %.3f ms\n",
+        entities.size(), names.size(), removed, appendMs, refreshMs);
+    if (entities.empty()) return;
+
+    const Projector projector(2560, 1440, 110, true);
+    const Mat3 R{ { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } } };
+    SpatialGrid grid;
+    UpdateScheduler updates;
+    std::vector<std::uint32_t> nearbyIdx, updateIdx;
+    EntitySubset nearby;
+    ProjectedPoints visible;
+    grid.build(entities.x.data(), entities.y.data(), entities.z.data(), entities.size(), maxDistance);
+
+    double planMs = 0, readMs = 0, projectMs = 0;
+    std::size_t reads = 0, projected = 0;
+    for (int f = 0; f < kFrames; ++f) {
+        const std::size_t at = ((std::size_t)(f / 30) * 7919) % entities.size();
+        const Vec3 cam{ entities.x[at], entities.y[at], entities.z[at] };
+
+        t0 = std::chrono::steady_clock::now();
+        nearbyIdx.clear();
+        grid.query(cam, maxDistance, nearbyIdx);
+        updates.plan(entities, nearbyIdx, projector, cam, R, maxDistance, updateIdx);
+        planMs += ms_since(t0);
+
+        t0 = std::chrono::steady_clock::now();
+        entities.refresh(updateIdx, deadVptr, vo.positionOffset, &readable);
+        readMs += ms_since(t0);
+        reads += updateIdx.size();
+
+        t0 = std::chrono::steady_clock::now();
+        entities.gather(nearbyIdx, nearby);
+        projected += project_batch(projector, nearby.x.data(), nearby.y.data(), nearby.z.data(),
+            nearby.index.size(), cam, R, maxDistance, visible);
+        projectMs += ms_since(t0);
+    }
+    std::printf("per frame over %d frames: grid+plan %.4f ms, refresh %.4f ms (%.0f reads), "
+        "gather+project_batch %.4f ms (%.0f visible)\n", kFrames, planMs / kFrames, readMs / kFrames,
+        (double)reads / kFrames, projectMs / kFrames, (double)projected / kFrames);
+}
+
+static int run_snapshot(const BenchConfig& cfg)
+{
+    SnapshotRegionProvider snap;
+    if (!snap.open(cfg.snapshot)) {
+        std::fprintf(stderr, "cannot open snapshot %s\n", cfg.snapshot.c_str());
+        return 1;
+    }
+    const std::vector<Region> regions = snap.enumerate();
+    std::size_t bytes = 0;
+    for (const Region& r : regions) bytes += r.size;
+    std::printf("snapshot: %zu regions, %zu MB, %zu skipped, %zu failed runs, module 0x%llx\n",
+        regions.size(), bytes >> 20, snap.skippedRegions(), snap.failedRuns(), (unsigned long long)snap.moduleBase());
+    std::printf("cpu best isa: %s\n\n", scan_isa_name(best_scan_isa()));
+    if (regions.empty()) return 1;
+
+    std::vector<std::uint64_t> needles = cfg.needles;
+    if (needles.empty()) {
+        for (const ClassType t : { ClassType::Pickup, ClassType::Movable, ClassType::Usable }) {
+            needles.push_back(snap.moduleBase() + (std::uintptr_t)t);
+        }
+    }
+
+    ThreadPoolConfig pc;
+    pc.threads = cfg.maxThreads;
+    pc.avoidCallerCore = false;
+    ScanThreadPool pool(pc);
+
+    ScanOptions opt;
+    opt.regions = &snap;
+    opt.policy = ScanPolicy::everything(); // политику уже применили при снятии
+    opt.threads = cfg.maxThreads;
+    opt.pool = &pool;
+
+    int failures = 0;
+    std::vector<std::size_t> reference[2]; // находки по иглам у первого ядра: выровненный, невыровненный
+    std::printf("%-10s %9s", "kernel", "GB/s");
+    for (std::size_t k = 0; k < needles.size(); ++k) std::printf("  hits[%zu]", k);
+    std::printf(" check\n");
+    for (const Kernel& kn : kKernels) {
+        if (resolve_scan_isa(kn.isa) != kn.isa) continue;
+        opt.isa = kn.isa;
+        opt.unaligned = kn.unaligned;
+        double best = 1e30;
+        std::vector<std::size_t> counts;
+        for (int i = 0; i < cfg.reps; ++i) {
+            counts.assign(needles.size(), 0);
+            const auto t0 = std::chrono::steady_clock::now();
+            scan_self_for_pointers_stream(needles,
+                [&](std::size_t k, std::span<const std::uintptr_t> block) { counts[k] += block.size(); }, opt);
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+        }
+        auto& ref = reference[kn.unaligned];
+        if (ref.empty()) ref = counts;
+        const bool ok = counts == ref;
+        failures += !ok;
+        std::printf("%-10s %9.2f", kn.name, bytes / best / 1e9);
+        for (const std::size_t c : counts) std::printf(" %9zu", c);
+        std::printf(" %s\n", ok ? "ok" : "MISMATCH");
+    }
+
+    // кандидаты выровненного скана через верификатор, как в startScanAsync
+    opt.isa = ScanIsa::Auto;
+    opt.unaligned = false;
+    const auto hits = scan_self_for_pointers(needles, opt);
+    std::printf("\n%-18s %9s %9s %9s %9s %9s %9s\n", "needle", "raw", "accepted", "unmapped", "fault", "name", "position");
+    std::vector<std::vector<std::uintptr_t>> accepted(needles.size());
+    for (std::size_t k = 0; k < needles.size(); ++k) {
+        CandidateVerifier verifier(regions);
+        verifier.verify(hits[k], accepted[k]);
+        const VerifyStats& vs = verifier.stats();
+        std::printf("0x%016llx %9zu %9zu %9zu %9zu %9zu %9zu\n", (unsigned long long)needles[k], vs.checked,
+            vs.accepted, vs.rejectedUnmapped, vs.rejectedFault, vs.rejectedName, vs.rejectedPosition);
+    }
+    run_entity_pipeline(accepted, regions, snap.moduleBase() + (std::uintptr_t)ClassType::DeadEntity, VerifyOptions{});
+    if (failures) std::printf("\n%d kernels disagree with the first one\n", failures);
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv)
+{
+    BenchConfig cfg;
+    if (!parse_args(argc, argv, cfg)) {
+        std::fprintf(stderr, "usage: %s [--size MB] [--region KB] [--density hits/MB] [--misaligned percent]"
+            " [--holes N] [--reps N] [--threads N]\n"
+            "       %s --snapshot PATH [--needle HEX]... [--reps N] [--threads N]\n", argv[0], argv[0]);
+        return 2;
+    }
+    if (!cfg.snapshot.empty()) return run_snapshot(cfg);
+
+    SyntheticHeap heap;
+    if (!build_heap(cfg, heap)) {
+        std::fprintf(stderr, "mmap failed\n");
+        return 1;
+    }
+    std::size_t bytes = 0;
+    for (const Region& r : heap.map.regions) bytes += r.size;
+    std::printf("heap: %zu regions x %zu KB = %zu MB, %zu aligned + %zu misaligned hits (%zu on chunk seams),"
+        " %zu holes\n", heap.map.regions.size(), cfg.regionKB, bytes >> 20, heap.alignedHits, heap.misalignedHits,
+        heap.seamHits, heap.holeBytes / heap.map.pageSize());
+    std::printf("cpu best isa: %s\n\n", scan_isa_name(best_scan_isa()));
+
+    std::vector<unsigned> threadCounts;
+    for (unsigned t = 1; t < cfg.maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(cfg.maxThreads);
+
+    ThreadPoolConfig pc;
+    pc.threads = cfg.maxThreads;
+    pc.avoidCallerCore = false;
+    ScanThreadPool pool(pc);
+
+    int failures = 0;
+    std::printf("%-10s %7s %9s %12s %8s %s\n", "kernel", "threads", "GB/s", "hits/s", "scaling", "check");
+    for (const Kernel& k : kKernels) {
+        // недоступный CPU набор понижается — такую строку не печатаем, она повторила бы другую
+        if (resolve_scan_isa(k.isa) != k.isa) continue;
+        const std::size_t expected = heap.alignedHits + (k.unaligned ? heap.misalignedHits : 0);
+        double base = 0;
+        for (const unsigned t : threadCounts) {
+            const Measure m = run_scan(heap, k.isa, k.unaligned, t, pool, cfg.reps);
+            const double gbs = bytes / m.seconds / 1e9;
+            if (t == 1) base = gbs;
+            const bool ok = m.hits == expected;
+            failures += !ok;
+            std::printf("%-10s %7u %9.2f %12.0f %7.2fx %s\n", k.name, t, gbs, m.hits / m.seconds,
+                base > 0 ? gbs / base : 0.0, ok ? "ok" : "MISMATCH");
+        }
+    }
+    if (failures) std::printf("\n%d runs returned a wrong hit count\n", failures);
+    return failures ? 1 : 0;
+}
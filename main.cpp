@@ -1,19 +1,29 @@
-﻿#include <windows.h>
+﻿#define NOMINMAX
+#include <windows.h>
 #include <d3d11.h>
 #include <dxgi.h>
+#include "AddressOracle.h"
+#include "EntityTable.h"
+#include "LabelLayout.h"
+#include "MarkerRenderer.h"
+#include "MemorySnapshot.h"
+#include "NameFilter.h"
 #include "ObjectScanner.h"
+#include "Profiler.h"
+#include "Projector.h"
+#include "SpatialGrid.h"
+#include "UpdateScheduler.h"
 #include "imgui.h"
 #include "backends/imgui_impl_win32.h"
 #include "backends/imgui_impl_dx11.h"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <string>
+#include <thread>
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "dxgi.lib")
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
 // --- глобалки ---
 typedef HRESULT(__stdcall* Present_t)(IDXGISwapChain*, UINT, UINT);
 Present_t oPresent = nullptr;
@@ -31,51 +41,6 @@ static ObjectScanner scanner;
 
 extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
-struct Vec3 {
-    float x, y, z;
-};
-struct Mat3 { float m[3][3]; };
-
-
-inline float Distance(const Vec3& a, const Vec3& b)
-{
-    float dx = a.x - b.x;
-    float dy = a.y - b.y;
-    float dz = a.z - b.z;
-    return std::sqrt(dx * dx + dy * dy + dz * dz);
-}
-
-struct Projector {
-    int W, H;
-    double halfW, halfH;
-    double kx, ky;
-    double signX;
-    Projector(int w, int h, float fov, bool right_is_negative = true)
-        : W(w), H(h), halfW(w * 0.5), halfH(h * 0.5), signX(right_is_negative ? -1.0 : 1.0)
-    {
-        const float aspect = double(W) / double(H);
-        const float Fh = fov * M_PI / 180.0;
-        const float Fv = 2.0 * std::atan(std::tan(Fh * 0.5) / aspect);
-        kx = halfW / std::tan(Fh * 0.5);
-        ky = halfH / std::tan(Fv * 0.5);
-    }
-
-    // Возвращает false, если точка за спиной/вне экрана
-    inline bool project(const Vec3& X_world, const Vec3& C_cam, const Mat3& R,
-        float& u, float &v) const noexcept
-    {
-        const Vec3 d = { X_world.x - C_cam.x, X_world.y - C_cam.y, X_world.z - C_cam.z };
-        const float cx = R.m[0][0] * d.x + R.m[0][1] * d.y + R.m[0][2] * d.z;
-        if (cx <= 0.0) return false;
-        const float cy = R.m[1][0] * d.x + R.m[1][1] * d.y + R.m[1][2] * d.z;
-        const float cz = R.m[2][0] * d.x + R.m[2][1] * d.y + R.m[2][2] * d.z;
-        u = halfW + signX * kx * (cy / cx);
-        v = halfH - ky * (cz / cx);
-        return (u >= 0.0 && u <= W && v >= 0.0 && v <= H);
-    }
-};
-
-
 LRESULT CALLBACK WndProcHook(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
     if (ImGui_ImplWin32_WndProcHandler(hWnd, msg, wParam, lParam))
@@ -84,13 +49,6 @@ LRESULT CALLBACK WndProcHook(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
     return CallWindowProc(g_OrigWndProc, hWnd, msg, wParam, lParam);
 }
 
-inline float Normalize(float x, float min, float max)
-{
-    if (max == min) return 0.0f; // защита от деления на ноль
-    return (x - min) / (max - min);
-}
-
-
 
 ImVec4 LerpColor(const ImVec4& c1, const ImVec4& c2, float t)
 {
@@ -103,17 +61,47 @@ ImVec4 LerpColor(const ImVec4& c1, const ImVec4& c2, float t)
 }
 
 
-static std::vector<uintptr_t> objectAddrs;
+static EntityTable entities;
+static RegionFilterStats lastScanStats;
+static VerifyStats lastVerifyStats;
 static Projector projector(2560, 1440, 110, true);
-uintptr_t camTransform = scanner.getCameraTransform();
-Vec3* camPos = reinterpret_cast<Vec3*>(camTransform);
-Mat3* camRot = reinterpret_cast<Mat3*>(camTransform + sizeof(Vec3));
-
-static uintptr_t deadEntityVptr = (uintptr_t)GetModuleHandle(NULL) + 0x1afc930;
+static ProjectedPoints visible;
+static SpatialGrid grid;
+static bool gridDirty = true;
+static std::vector<std::uint32_t> nearbyIdx, updateIdx;
+static UpdateScheduler updates;
+static EntitySubset nearby;
+static NameTable names;
+static NameFilter nameFilter;
+static std::vector<std::uint8_t> nameVerdict; // по id имени: показывать ли объект
+static std::vector<ImVec2> nameExtent;         // по id имени: размер текста
+static float nameExtentFont = 0.0f;
+static LabelLayout labelLayout;
+static MarkerRenderer markerRenderer;
+static MarkerStyle markerStyle;
+static AddressOracle oracle;
+static std::uint64_t oracleGeneration = 0;
+// Снятие снимка памяти для воспроизведения скана вне игры
+static std::atomic<bool> snapshotBusy{ false };
+static SnapshotStats lastSnapshotStats;
+static std::vector<LabelCandidate> labelCandidates;
+static FrameProfiler frameProfiler;
+static std::vector<ScanProfile> scanHistory; // последние сканы, старые в начале
+static constexpr std::size_t kScanHistory = 32;
+static std::string profileExportStatus;
+// Адреса из памяти игры; находятся по сигнатурам при первом Present
+uintptr_t camTransform = 0;
+Vec3* camPos = nullptr;
+Mat3* camRot = nullptr;
+
+static uintptr_t deadEntityVptr = 0;
+static constexpr std::size_t kNameOffset = 0x30;
+static constexpr std::size_t kPositionOffset = 0x300;
 
 // --- наш Present ---
 HRESULT __stdcall HookPresent(IDXGISwapChain* swap, UINT sync, UINT flags)
 {
+    frameProfiler.beginFrame();
     if (!g_Init) {
         swap->GetDevice(__uuidof(ID3D11Device), (void**)&g_Device);
         g_Device->GetImmediateContext(&g_Context);
@@ -132,6 +120,14 @@ HRESULT __stdcall HookPresent(IDXGISwapChain* swap, UINT sync, UINT flags)
         ImGui_ImplDX11_Init(g_Device, g_Context);
         g_OrigWndProc = (WNDPROC)SetWindowLongPtr(g_hWnd, GWLP_WNDPROC, (LONG_PTR)WndProcHook);
     
+        // не в DllMain: резолв читает весь код модуля, а под loader lock это недопустимо
+        scanner.resolveAddresses("DishonoredWH.sig", "DishonoredWH.sigcache");
+        camTransform = scanner.getCameraTransform();
+        camPos = reinterpret_cast<Vec3*>(camTransform);
+        camRot = reinterpret_cast<Mat3*>(camTransform + sizeof(Vec3));
+        deadEntityVptr = scanner.classVptr(ClassType::DeadEntity);
+
+        oracle.start();
         g_Init = true;
     }
 
@@ -149,10 +145,12 @@ HRESULT __stdcall HookPresent(IDXGISwapChain* swap, UINT sync, UINT flags)
     static float maxDistance = 80.0f;
 	static float dotsSize = 15.0f;
     static bool showNames = false;
-    static std::vector<std::string> filters;
+    static std::vector<FilterRule> filters;
+    static bool ruleInclude = false, rulePrefix = false, ruleIgnoreCase = false;
     static int selectedIndex = -1;        
     static char inputBuffer[128] = "";
     static float textOffset[2] = {-200.0f, -200.0f};
+    static int labelBudget = 150;
 
     if (g_ShowMenu) {
         ImGui::Begin("Overlay Menu");
@@ -161,32 +159,73 @@ HRESULT __stdcall HookPresent(IDXGISwapChain* swap, UINT sync, UINT flags)
         {
             if (ImGui::BeginTabItem("General"))
             {
-                if (ImGui::Button("Reload Cache")) {
-                    objectAddrs = scanner.scanForType(ClassType::Pickup);
-                    objectAddrs.erase(
-                        std::remove_if(objectAddrs.begin(), objectAddrs.end(),
-                            [](uintptr_t addr) {
-                                const char* name = reinterpret_cast<const char*>(addr + 0x30);
-                                if (!name) return true;
-
-                                std::string s(name);
-                                for (const auto& f : filters) {
-                                    if (s.find(f) != std::string::npos) {
-                                        return true;
-                                    }
-                                }
-                                return false;
-                            }),
-                        objectAddrs.end()
-                    );
+                if (scanner.scanInProgress()) {
+                    // скан идёт в фоне, кадры не стоят
+                    ImGui::ProgressBar(scanner.scanProgress(), ImVec2(-FLT_MIN, 0.0f));
+                    if (ImGui::Button("Cancel")) {
+                        scanner.cancelScan();
+                    }
+                }
+                else if (ImGui::Button("Reload Cache")) {
+                    // фильтры по имени применяются на лету к готовому списку, скан их не ждёт
+                    scanner.startScanAsync({ ClassType::Pickup });
                 }
                 if (ImGui::Button("Clean List")) {
-                    objectAddrs.clear();
+                    entities.clear();
+                }
+                ImGui::SameLine();
+                if (snapshotBusy.load(std::memory_order_acquire)) {
+                    ImGui::TextUnformatted("Saving snapshot...");
+                }
+                else if (ImGui::Button("Save Snapshot")) {
+                    // те же регионы, что видит сканер; пишется в фоне, кадры не стоят.
+                    // Поток отпускается: завершение отслеживает snapshotBusy, а joinable
+                    // std::thread в статике уронил бы процесс на выходе из игры
+                    snapshotBusy.store(true, std::memory_order_release);
+                    // Итог пишется в lastSnapshotStats одним присваиванием перед сбросом флага:
+                    // рендер читает его только после acquire-загрузки snapshotBusy == false
+                    std::thread([policy = scanner.scanPolicy()] {
+                        SnapshotStats st;
+                        write_snapshot("DishonoredWH.snap", default_region_provider(), policy,
+                            main_module_base(), &st);
+                        lastSnapshotStats = st;
+                        snapshotBusy.store(false, std::memory_order_release);
+                        }).detach();
+                }
+                if (!snapshotBusy.load(std::memory_order_acquire) && lastSnapshotStats.regions) {
+                    ImGui::Text("Snapshot: %zu regions, %zu pages written, %zu zero pages skipped",
+                        lastSnapshotStats.regions, lastSnapshotStats.dataPages, lastSnapshotStats.zeroPages);
                 }
+                if (lastScanStats.regionsTotal) {
+                    const float mb = 1.0f / (1024.0f * 1024.0f);
+                    ImGui::Text("Scanned %.0f MB of %.0f MB", lastScanStats.bytesKept * mb, lastScanStats.bytesTotal * mb);
+                    ImGui::Text("Skipped: type %.0f MB, protect %.0f MB, size %.0f MB, module %.0f MB",
+                        lastScanStats.skippedType * mb, lastScanStats.skippedProtect * mb,
+                        lastScanStats.skippedSize * mb, lastScanStats.skippedModule * mb);
+                    ImGui::Text("Candidates: %zu accepted of %zu (unmapped %zu, fault %zu, name %zu, position %zu)",
+                        lastVerifyStats.accepted, lastVerifyStats.checked, lastVerifyStats.rejectedUnmapped,
+                        lastVerifyStats.rejectedFault, lastVerifyStats.rejectedName, lastVerifyStats.rejectedPosition);
+                }
+                int readBudget = (int)updates.tiers.readBudget;
+                if (ImGui::SliderInt("Read Budget", &readBudget, 64, 8192)) updates.tiers.readBudget = (std::size_t)readBudget;
+                ImGui::SliderFloat("Every-frame Radius", &updates.tiers.nearRadius, 0.0f, 200.0f);
+                int intervals[3] = { (int)updates.tiers.visibleInterval, (int)updates.tiers.offscreenInterval,
+                    (int)updates.tiers.farInterval };
+                if (ImGui::SliderInt3("Visible / Off-screen / Far", intervals, 1, 240)) {
+                    updates.tiers.visibleInterval = (unsigned)intervals[0];
+                    updates.tiers.offscreenInterval = (unsigned)intervals[1];
+                    updates.tiers.farInterval = (unsigned)intervals[2];
+                }
+                const UpdateScheduler::Stats& us = updates.stats();
+                ImGui::Text("Reads: %zu near, %zu visible, %zu off-screen, %zu far, %zu deferred",
+                    us.near, us.visible, us.offscreen, us.far, us.deferred);
                 ImGui::Checkbox("Show names", &showNames);
                 if (showNames)
                 {
                     ImGui::SliderFloat2("Text Offset", textOffset, -200.0f, 200.0f);
+                    ImGui::SliderInt("Label Budget", &labelBudget, 10, 1000);
+                    ImGui::Text("Labels: %zu shown, %zu merged, %zu hidden",
+                        labelLayout.placed().size(), labelLayout.merged(), labelLayout.dropped());
                 }
                 ImGui::EndTabItem();
             }
@@ -199,6 +238,22 @@ HRESULT __stdcall HookPresent(IDXGISwapChain* swap, UINT sync, UINT flags)
                 ImGui::SliderFloat("Max Distance", &maxDistance, 10.0f, 1000.0f);
                 ImGui::SliderFloat("Dots Size", &dotsSize, 1.0f, 30.0f);
 
+                const char* markerModes[] = { "Circle", "Fixed", "Distance LOD", "Quad" };
+                ImGui::Combo("Dots Mode", reinterpret_cast<int*>(&markerStyle.mode), markerModes, IM_ARRAYSIZE(markerModes));
+                if (markerStyle.mode == MarkerMode::Fixed || markerStyle.mode == MarkerMode::Lod)
+                    ImGui::SliderInt("Segments", &markerStyle.maxSegments, 3, 32);
+                if (markerStyle.mode == MarkerMode::Lod)
+                    ImGui::SliderInt("Far Segments", &markerStyle.minSegments, 3, markerStyle.maxSegments);
+                int vtxBudget = (int)markerStyle.vertexBudget;
+                if (ImGui::SliderInt("Vertex Budget", &vtxBudget, 1024, 65536)) {
+                    markerStyle.vertexBudget = (std::size_t)vtxBudget;
+                    markerStyle.indexBudget = (std::size_t)vtxBudget * 3;
+                }
+                const MarkerStats& ms = markerRenderer.stats();
+                ImGui::Text("Dots: %zu drawn, %zu simplified, %zu dropped", ms.drawn, ms.degraded, ms.dropped);
+                ImGui::Text("Vertices %zu / %zu, indices %zu / %zu", ms.vertices, markerStyle.vertexBudget,
+                    ms.indices, markerStyle.indexBudget);
+
                 ImGui::EndTabItem();
             }
 
@@ -209,7 +264,10 @@ HRESULT __stdcall HookPresent(IDXGISwapChain* swap, UINT sync, UINT flags)
                     for (int i = 0; i < (int)filters.size(); i++)
                     {
                         const bool isSelected = (selectedIndex == i);
-                        if (ImGui::Selectable(filters[i].c_str(), isSelected))
+                        const FilterRule& r = filters[i];
+                        std::string label = std::string(r.include ? "+ " : "- ") + (r.prefix ? "^" : "") + r.pattern
+                            + (r.ignoreCase ? "  (Aa)" : "") + "##" + std::to_string(i);
+                        if (ImGui::Selectable(label.c_str(), isSelected))
                             selectedIndex = i;
 
                         if (isSelected)
@@ -223,9 +281,16 @@ HRESULT __stdcall HookPresent(IDXGISwapChain* swap, UINT sync, UINT flags)
                 ImGui::SameLine();
                 if (ImGui::Button("Add") && strlen(inputBuffer) > 0)
                 {
-                    filters.push_back(inputBuffer);
+                    filters.push_back({ inputBuffer, ruleInclude, rulePrefix, ruleIgnoreCase });
                     inputBuffer[0] = '\0';
+                    nameFilter.compile(filters);
+                    nameVerdict.clear();
                 }
+                ImGui::Checkbox("Include", &ruleInclude);
+                ImGui::SameLine();
+                ImGui::Checkbox("Prefix", &rulePrefix);
+                ImGui::SameLine();
+                ImGui::Checkbox("Ignore case", &ruleIgnoreCase);
 
                 if (selectedIndex >= 0)
                 {
@@ -233,6 +298,8 @@ HRESULT __stdcall HookPresent(IDXGISwapChain* swap, UINT sync, UINT flags)
                     {
                         filters.erase(filters.begin() + selectedIndex);
                         selectedIndex = -1;
+                        nameFilter.compile(filters);
+                        nameVerdict.clear();
                     }
                 }
                 if (selectedIndex == -1)
@@ -245,49 +312,197 @@ HRESULT __stdcall HookPresent(IDXGISwapChain* swap, UINT sync, UINT flags)
                 ImGui::EndTabItem();
             }
 
+            if (ImGui::BeginTabItem("Profiler"))
+            {
+                const FrameProfiler::Stats iv = frameProfiler.interval();
+                const FrameProfiler::Stats tot = frameProfiler.total();
+                ImGui::Text("Frame %.2f ms (%.0f FPS), max %.2f ms", iv.avg, iv.avg > 0 ? 1000.0 / iv.avg : 0.0, iv.max);
+                ImGui::Text("Hook %.3f ms avg, %.3f ms max (Present included)", tot.avg, tot.max);
+                ImGui::PlotLines("##HookHistory",
+                    [](void* data, int i) { return static_cast<FrameProfiler*>(data)->totalAt((std::size_t)i); },
+                    &frameProfiler, (int)frameProfiler.frames(), 0, "hook, ms", 0.0f, FLT_MAX, ImVec2(-FLT_MIN, 60.0f));
+
+                if (ImGui::BeginTable("##Stages", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp))
+                {
+                    ImGui::TableSetupColumn("Stage");
+                    ImGui::TableSetupColumn("Last, ms");
+                    ImGui::TableSetupColumn("Avg, ms");
+                    ImGui::TableSetupColumn("Max, ms");
+                    ImGui::TableHeadersRow();
+                    for (std::size_t i = 0; i < FrameProfiler::kStages; ++i) {
+                        const FrameProfiler::Stats st = frameProfiler.stage((FrameStage)i);
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn(); ImGui::TextUnformatted(frame_stage_name((FrameStage)i));
+                        ImGui::TableNextColumn(); ImGui::Text("%.3f", st.last);
+                        ImGui::TableNextColumn(); ImGui::Text("%.3f", st.avg);
+                        ImGui::TableNextColumn(); ImGui::Text("%.3f", st.max);
+                    }
+                    ImGui::EndTable();
+                }
+                bool paused = frameProfiler.isPaused();
+                if (ImGui::Checkbox("Pause history", &paused)) frameProfiler.setPaused(paused);
+
+                ImGui::Separator();
+                if (!scanHistory.empty()) {
+                    const ScanProfile& sp = scanHistory.back();
+                    const float mb = 1.0f / (1024.0f * 1024.0f);
+                    ImGui::Text("Last scan%s: %.3f s, %.0f MB, %.2f GB/s, %zu raw hits",
+                        sp.incremental ? " (incremental)" : "", sp.seconds, sp.total.bytes * mb,
+                        sp.gigabytesPerSecond(), sp.hits);
+                    ImGui::Text("Pages: %zu scanned, %zu reused, %zu safe fallback", sp.total.pages,
+                        sp.total.pagesReused, sp.total.faultPages);
+                    for (std::size_t t = 0; t < sp.threads.size(); ++t) {
+                        char overlay[64];
+                        snprintf(overlay, sizeof(overlay), "worker %zu: %zu chunks", t, sp.threads[t].chunks);
+                        ImGui::ProgressBar((float)sp.utilization(t), ImVec2(-FLT_MIN, 0.0f), overlay);
+                    }
+                }
+                else {
+                    ImGui::TextUnformatted("No scans yet");
+                }
+
+                ImGui::Separator();
+                if (ImGui::Button("Export CSV")) {
+                    const bool ok = write_frames_csv("DishonoredWH.frames.csv", frameProfiler) &&
+                        write_scans_csv("DishonoredWH.scans.csv", scanHistory);
+                    profileExportStatus = ok ? "Saved DishonoredWH.frames.csv, DishonoredWH.scans.csv" : "Export failed";
+                }
+                ImGui::SameLine();
+                if (ImGui::Button("Export JSON")) {
+                    profileExportStatus = write_profile_json("DishonoredWH.profile.json", frameProfiler, scanHistory)
+                        ? "Saved DishonoredWH.profile.json" : "Export failed";
+                }
+                if (!profileExportStatus.empty()) ImGui::TextUnformatted(profileExportStatus.c_str());
+
+                ImGui::EndTabItem();
+            }
+
             ImGui::EndTabBar();
         }
 
         ImGui::End();
     }
+    frameProfiler.lap(FrameStage::Menu);
+
+    // Все чтения памяти игры ниже сверяются с картой читаемой памяти. Карта поменялась
+    // (например, выгрузили уровень) — объекты, оставшиеся без памяти, выбывают в этом же кадре.
+    // Но сама карта отстаёт от игры до 250 мс (AddressOracle::start): память, освобождённая
+    // за это время, ещё считается читаемой — поэтому перед загрузкой уровня жмут Clean List.
+    const auto readable = oracle.snapshot();
+    if (readable->generation != oracleGeneration) {
+        oracleGeneration = readable->generation;
+        entities.evictUnreadable(*readable, kPositionOffset);
+    }
+    frameProfiler.lap(FrameStage::Evict);
+
+    // Готовый результат фонового скана подменяет список целиком
+    if (auto res = scanner.takeScanResult()) {
+        entities.clear();
+        entities.append(res->hits[0], 0, kNameOffset, names);
+        entities.refresh(deadEntityVptr, kPositionOffset, readable.get());
+        gridDirty = true;
+        lastScanStats = res->filterStats;
+        lastVerifyStats = res->verifyStats;
+        if (scanHistory.size() >= kScanHistory) scanHistory.erase(scanHistory.begin());
+        scanHistory.push_back(res->profile);
+    }
+    frameProfiler.lap(FrameStage::Ingest);
 
     ImDrawList* drawList = ImGui::GetForegroundDrawList();
 
-    for (const auto& pt : objectAddrs) {
-        Vec3* objPos = reinterpret_cast<Vec3*>(pt + 0x300);
-        std::erase_if(objectAddrs, [](uintptr_t pt) {
-            Vec3* objPos = reinterpret_cast<Vec3*>(pt + 0x300);
-            return *(uintptr_t*)pt == deadEntityVptr;
-            });
-            
-		float dist = Distance(*objPos, *camPos);
-        if(dist > maxDistance)
-			continue;
-
-        
-
-        float x, y;
-            if (projector.project(*objPos, *camPos, *camRot,x,y))
-            {
-				float norm = Normalize(dist, 0.0f, maxDistance);
+    // Сетка строится по уже прочитанным позициям: после удаления мёртвых, переезда объектов
+    // в другие ячейки и когда радиус ушёл далеко от размера ячейки
+    if (entities.compact()) gridDirty = true;
+    if (grid.size() != entities.size()) gridDirty = true;
+    if (maxDistance > grid.cellSize() * 2.0f || maxDistance < grid.cellSize() * 0.5f) gridDirty = true;
+    if (gridDirty) {
+        grid.build(entities.x.data(), entities.y.data(), entities.z.data(), entities.size(), maxDistance);
+        gridDirty = false;
+    }
+    frameProfiler.lap(FrameStage::Grid);
+
+    // Камера тоже в памяти игры, и на загрузке уровня её может не быть
+    const bool cameraOk = readable->readable(camTransform, sizeof(Vec3) + sizeof(Mat3));
+    const Vec3 cam = cameraOk ? *camPos : Vec3{};
+    const Mat3 camR = cameraOk ? *camRot : Mat3{};
+
+    // Рисуем только объекты из ячеек рядом с камерой. В память игры за кадр ходим не больше
+    // чем за readBudget из них: ближние — каждый кадр, остальные — реже, дальние — по кругу,
+    // чтобы заметить ушедших из своей ячейки. Между чтениями — последние прочитанные значения.
+    nearbyIdx.clear();
+    if (cameraOk) grid.query(cam, maxDistance, nearbyIdx);
+    updates.plan(entities, nearbyIdx, projector, cam, camR, maxDistance, updateIdx);
+    entities.refresh(updateIdx, deadEntityVptr, kPositionOffset, readable.get());
+    if (grid.moved(entities.x.data(), entities.y.data(), entities.z.data(), updateIdx)) gridDirty = true;
+    frameProfiler.lap(FrameStage::Update);
+
+    // Правило проверяется один раз на уникальное имя; после правки фильтров — заново по всем
+    nameFilter.classify(names, nameVerdict);
+    entities.gather(nearbyIdx, nearby, nameVerdict);
+    frameProfiler.lap(FrameStage::Nearby);
+
+    // Точный отсев по дальности и проекция кандидатов разом, дальше рисуем только видимые
+    if (cameraOk) {
+        project_batch(projector, nearby.x.data(), nearby.y.data(), nearby.z.data(), nearby.index.size(),
+            cam, camR, maxDistance, visible);
+    }
+    else {
+        visible.count = 0;
+    }
+    frameProfiler.lap(FrameStage::Project);
+
+    auto pointColor = [&](std::size_t k) {
+        ImVec4 col = LerpColor(ImVec4(colNear[0], colNear[1], colNear[2], colNear[3]),ImVec4(colFar[0], colFar[1], colFar[2], colFar[3]), visible.norm[k]);
+        return ImGui::ColorConvertFloat4ToU32(col);
+    };
+    markerStyle.radius = dotsSize;
+    markerRenderer.draw(drawList, visible, markerStyle,
+        ImVec4(colNear[0], colNear[1], colNear[2], colNear[3]), ImVec4(colFar[0], colFar[1], colFar[2], colFar[3]));
+    frameProfiler.lap(FrameStage::Markers);
+
+    if (showNames)
+    {
+        // Размер текста считается один раз на имя; сменился шрифт — пересчитываем все
+        if (ImGui::GetFontSize() != nameExtentFont) {
+            nameExtent.clear();
+            nameExtentFont = ImGui::GetFontSize();
+        }
+        for (std::size_t id = nameExtent.size(); id < names.size(); ++id) {
+            nameExtent.push_back(ImGui::CalcTextSize(names.str((std::uint32_t)id).c_str()));
+        }
 
-                ImVec4 col = LerpColor(ImVec4(colNear[0], colNear[1], colNear[2], colNear[3]),ImVec4(colFar[0], colFar[1], colFar[2], colFar[3]), norm);
-                ImU32 color = ImGui::ColorConvertFloat4ToU32(col);
-                drawList->AddCircleFilled(ImVec2(x, y), dotsSize, color);
-                if (showNames)
-                {
-                    const char* objName = reinterpret_cast<const char*>(pt + 0x30);
-                    drawList->AddText(ImVec2(textOffset[0] + x, textOffset[1] + y), color, objName);
-                }
-                
+        labelCandidates.clear();
+        for (std::size_t k = 0; k < visible.count; ++k) {
+            const std::uint32_t id = entities.nameId[nearby.index[visible.index[k]]];
+            labelCandidates.push_back({ textOffset[0] + visible.u[k], textOffset[1] + visible.v[k],
+                nameExtent[id].x, nameExtent[id].y, visible.norm[k], id, (std::uint32_t)k });
+        }
+        const ImVec2 screen = ImGui::GetIO().DisplaySize;
+        labelLayout.layout(labelCandidates, screen.x, screen.y, (std::size_t)labelBudget);
+
+        char merged[160];
+        for (const auto& l : labelLayout.placed()) {
+            const char* text = names.str(l.nameId).c_str();
+            if (l.merged) {
+                snprintf(merged, sizeof(merged), "%s x%u", text, l.merged + 1);
+                text = merged;
             }
+            drawList->AddText(ImVec2(l.x, l.y), pointColor(l.point), text);
+        }
     }
+    frameProfiler.lap(FrameStage::Labels);
     ImGui::Render();
     g_Context->OMSetRenderTargets(1, &g_RTV, nullptr);
     ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+    frameProfiler.lap(FrameStage::Render);
 
-
-    return oPresent(swap, sync, flags);
+    HRESULT hr;
+    {
+        ProfileScope present(frameProfiler, FrameStage::Present);
+        hr = oPresent(swap, sync, flags);
+    }
+    frameProfiler.endFrame();
+    return hr;
 }
 
 void HookSwapChain()
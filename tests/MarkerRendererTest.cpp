@@ -0,0 +1,91 @@
+// MarkerRenderer без окна и GPU: маркеры пишутся в ImDrawList на собственном
+// ImDrawListSharedData, после чего проверяется сам список (только Linux, нужен imgui).
+//
+// Для каждого режима рисуется N точек с бюджетом меньше, чем нужно на все: вершин и индексов
+// в списке ровно столько, сколько насчитал MarkerStats, и не больше бюджета; каждая точка
+// либо нарисована, либо выброшена; индексы не выходят за вершины. Отдельно — запас бюджета
+// на все точки: тогда не выбрасывается ни одна.
+
+#include "MarkerRenderer.h"
+
+#include <cstdio>
+#include <vector>
+
+static ProjectedPoints make_points(std::size_t n)
+{
+    ProjectedPoints pts;
+    pts.count = n;
+    pts.index.resize(n);
+    pts.u.resize(n);
+    pts.v.resize(n);
+    pts.norm.resize(n);
+    for (std::size_t k = 0; k < n; ++k) {
+        pts.index[k] = (std::uint32_t)k;
+        pts.u[k] = 40.0f + (float)(k % 50) * 50.0f;
+        pts.v[k] = 40.0f + (float)(k / 50) * 30.0f;
+        pts.norm[k] = (float)((k * 37) % n) / (float)n; // ближние вперемешку с дальними
+    }
+    return pts;
+}
+
+static int check(const char* name, ImDrawListSharedData& shared, MarkerRenderer& r, const ProjectedPoints& pts,
+    const MarkerStyle& style, bool expectAll)
+{
+    ImDrawList dl(&shared);
+    dl._ResetForNewFrame();
+    const MarkerStats& st = r.draw(&dl, pts, style, ImVec4(0, 1, 0, 1), ImVec4(1, 0, 0, 0.25f));
+
+    const std::size_t vtx = (std::size_t)dl.VtxBuffer.Size, idx = (std::size_t)dl.IdxBuffer.Size;
+    bool ok = vtx == st.vertices && idx == st.indices;
+    ok = ok && vtx <= style.vertexBudget && idx <= style.indexBudget;
+    ok = ok && st.drawn + st.dropped == pts.count;
+    ok = ok && (!expectAll || st.dropped == 0);
+    for (int i = 0; ok && i < dl.IdxBuffer.Size; ++i) ok = dl.IdxBuffer[i] < dl.VtxBuffer.Size;
+
+    std::printf("%-14s %s: %zu drawn, %zu simplified, %zu dropped, vtx %zu/%zu (%zu), idx %zu/%zu (%zu)\n",
+        name, ok ? "ok  " : "FAIL", st.drawn, st.degraded, st.dropped, st.vertices, style.vertexBudget, vtx,
+        st.indices, style.indexBudget, idx);
+    return ok ? 0 : 1;
+}
+
+int main()
+{
+    // то же, что ImGui::NewFrame выставляет общим данным по умолчанию
+    ImDrawListSharedData shared;
+    shared.SetCircleTessellationMaxError(0.30f);
+    shared.InitialFlags = ImDrawListFlags_AntiAliasedLines | ImDrawListFlags_AntiAliasedFill;
+
+    const ProjectedPoints pts = make_points(1000);
+    MarkerRenderer r;
+    int failed = 0;
+
+    struct Mode { const char* name; MarkerMode mode; };
+    const Mode modes[] = {
+        { "circle", MarkerMode::Circle },
+        { "fixed", MarkerMode::Fixed },
+        { "lod", MarkerMode::Lod },
+        { "quad", MarkerMode::Quad },
+    };
+    for (const Mode& m : modes) {
+        MarkerStyle style;
+        style.mode = m.mode;
+        // бюджет не кратен цене маркера ни в одном режиме: последний влезающий упрётся в край
+        style.vertexBudget = 4999;
+        style.indexBudget = 3 * 4999;
+        failed += check(m.name, shared, r, pts, style, false);
+
+        style.vertexBudget = 60000; // ImDrawIdx 16-битный: одна команда, без смены VtxOffset
+        style.indexBudget = 400000;
+        char name[32];
+        std::snprintf(name, sizeof(name), "%s-all", m.name);
+        failed += check(name, shared, r, make_points(300), style, true);
+    }
+
+    // бюджет меньше одного маркера: не рисуется ничего
+    MarkerStyle tiny;
+    tiny.mode = MarkerMode::Circle;
+    tiny.vertexBudget = 3;
+    tiny.indexBudget = 3;
+    failed += check("circle-tiny", shared, r, pts, tiny, false);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,127 @@
+// project_batch против поточечных Distance + Projector::project (только Linux).
+//
+// Для каждого доступного набора инструкций (Scalar, AVX2, AVX-512) на одном входе
+// сравниваются список видимых точек и их экранные координаты. Вход: случайные точки
+// вокруг камеры, точки за спиной, точки ровно на границе отсечения по дальности и чуть
+// за ней, NaN в любой координате; длина не кратна ширине вектора, так что хвост
+// проходит скалярный остаток.
+
+#include "CpuFeatures.h"
+#include "Projector.h"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+struct Expected {
+    std::vector<std::uint32_t> index;
+    std::vector<float> u, v, norm;
+};
+
+static Expected reference(const Projector& p, const std::vector<float>& x, const std::vector<float>& y,
+    const std::vector<float>& z, const Vec3& cam, const Mat3& R, float maxDistance)
+{
+    Expected e;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        const Vec3 X{ x[i], y[i], z[i] };
+        const float d = Distance(X, cam);
+        if (!(d <= maxDistance)) continue;
+        float u, v;
+        if (!p.project(X, cam, R, u, v)) continue;
+        e.index.push_back((std::uint32_t)i);
+        e.u.push_back(u);
+        e.v.push_back(v);
+        e.norm.push_back(d / maxDistance);
+    }
+    return e;
+}
+
+static bool close(float a, float b)
+{
+    return std::fabs(a - b) <= 1e-4f * std::max(1.0f, std::fabs(b));
+}
+
+static int check(const char* name, ScanIsa isa, const Projector& p, const std::vector<float>& x,
+    const std::vector<float>& y, const std::vector<float>& z, const Vec3& cam, const Mat3& R,
+    float maxDistance, const Expected& e)
+{
+    ProjectedPoints out;
+    const std::size_t n = project_batch(p, x.data(), y.data(), z.data(), x.size(), cam, R, maxDistance, out, isa);
+    if (n != e.index.size()) {
+        std::printf("%s: %zu visible, expected %zu\n", name, n, e.index.size());
+        return 1;
+    }
+    for (std::size_t k = 0; k < n; ++k) {
+        if (out.index[k] != e.index[k] || !close(out.u[k], e.u[k]) || !close(out.v[k], e.v[k]) ||
+            !close(out.norm[k], e.norm[k])) {
+            std::printf("%s: point %zu: index %u (%g, %g, %g), expected %u (%g, %g, %g)\n", name, k,
+                out.index[k], out.u[k], out.v[k], out.norm[k], e.index[k], e.u[k], e.v[k], e.norm[k]);
+            return 1;
+        }
+    }
+    std::printf("%-7s ok (%zu of %zu visible)\n", name, n, x.size());
+    return 0;
+}
+
+int main()
+{
+    const Projector p(2560, 1440, 110, true);
+    const float maxDistance = 80.0f;
+    const Vec3 cam{ 10.0f, -20.0f, 5.0f };
+    // поворот вокруг вертикали на 30 градусов: вперёд — строка 0
+    const float c = std::cos(0.5235988f), s = std::sin(0.5235988f);
+    const Mat3 R{ { { c, s, 0.0f }, { -s, c, 0.0f }, { 0.0f, 0.0f, 1.0f } } };
+
+    std::vector<float> x, y, z;
+    const auto add = [&](float px, float py, float pz) {
+        x.push_back(px);
+        y.push_back(py);
+        z.push_back(pz);
+    };
+
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> coord(-120.0f, 120.0f);
+    for (int i = 0; i < 997; ++i) add(cam.x + coord(rng), cam.y + coord(rng), cam.z + coord(rng) * 0.25f);
+
+    // за спиной и в плоскости камеры (cx == 0)
+    add(cam.x - c * 10.0f, cam.y - s * 10.0f, cam.z);
+    add(cam.x - s * 10.0f, cam.y + c * 10.0f, cam.z);
+    add(cam.x, cam.y, cam.z);
+    // ровно на дальности: 6400 = 80^2 = 48^2 + 64^2 точно в float; и чуть дальше
+    add(cam.x + 80.0f, cam.y, cam.z);
+    add(cam.x + 48.0f, cam.y + 64.0f, cam.z);
+    add(cam.x + 48.0f, cam.y, cam.z + 64.0f);
+    add(cam.x + 80.001f, cam.y, cam.z);
+    add(cam.x + 48.0f, cam.y + 64.001f, cam.z);
+    // NaN в каждой координате по очереди
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    add(nan, cam.y, cam.z);
+    add(cam.x + 5.0f, nan, cam.z);
+    add(cam.x + 5.0f, cam.y, nan);
+    add(nan, nan, nan);
+    // хвост из видимых точек, чтобы остаток скалярного пути не был пустым
+    for (int i = 0; i < 13; ++i) add(cam.x + c * (5.0f + i), cam.y + s * (5.0f + i), cam.z);
+
+    // 1022 точки: не кратно ни 8, ни 16
+    const Expected e = reference(p, x, y, z, cam, R, maxDistance);
+    if (e.index.empty()) {
+        std::printf("reference: no visible points\n");
+        return 1;
+    }
+
+    int failed = check("scalar", ScanIsa::Scalar, p, x, y, z, cam, R, maxDistance, e);
+    if (cpu_features().avx2) failed += check("avx2", ScanIsa::AVX2, p, x, y, z, cam, R, maxDistance, e);
+    else std::printf("avx2    skipped: not supported by CPU\n");
+    if (cpu_features().avx512f) failed += check("avx512", ScanIsa::AVX512, p, x, y, z, cam, R, maxDistance, e);
+    else std::printf("avx512  skipped: not supported by CPU\n");
+
+    // короткие входы целиком уходят в скалярный остаток
+    for (std::size_t n : { 0, 1, 7, 15, 17 }) {
+        const std::vector<float> sx(x.end() - n, x.end()), sy(y.end() - n, y.end()), sz(z.end() - n, z.end());
+        const Expected se = reference(p, sx, sy, sz, cam, R, maxDistance);
+        failed += check("best", ScanIsa::Auto, p, sx, sy, sz, cam, R, maxDistance, se);
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,84 @@
+// UpdateScheduler: бюджет, отсутствие повторов в одном кадре и сроки по ярусам (только Linux).
+//
+// Таблица заполняется напрямую, в память игры никто не ходит: план проверяется сам по себе.
+// Бюджет намеренно мал относительно числа объектов у камеры, чтобы у средних копилась
+// просрочка и круговой обход дальних доходил до них.
+
+#include "UpdateScheduler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+int main()
+{
+    constexpr std::size_t kCount = 20000;
+    EntityTable t;
+    t.addr.resize(kCount);
+    t.nameId.assign(kCount, 0);
+    t.type.assign(kCount, 0);
+    t.dead.assign(kCount, 0);
+    t.readFrame.assign(kCount, 0);
+    t.x.resize(kCount);
+    t.y.resize(kCount);
+    t.z.resize(kCount);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coord(-500.0f, 500.0f);
+    for (std::size_t i = 0; i < kCount; ++i) {
+        t.addr[i] = 0x10000 + i * 16;
+        t.x[i] = coord(rng);
+        t.y[i] = coord(rng);
+        t.z[i] = coord(rng) * 0.1f;
+    }
+
+    const Projector p(2560, 1440, 110, true);
+    const Mat3 R{ { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } } };
+    const Vec3 cam{ 0, 0, 0 };
+    const float maxDistance = 80.0f, cellRadius = 150.0f;
+    const auto distSq = [&](std::size_t i) { return t.x[i] * t.x[i] + t.y[i] * t.y[i] + t.z[i] * t.z[i]; };
+
+    // «ячейки у камеры» — круг побольше maxDistance, как отдаёт SpatialGrid::query
+    std::vector<std::uint32_t> nearby;
+    for (std::uint32_t i = 0; i < kCount; ++i) {
+        if (distSq(i) < cellRadius * cellRadius) nearby.push_back(i);
+    }
+
+    int failed = 0;
+    for (const std::size_t budget : { std::size_t(64), std::size_t(512) }) {
+        UpdateScheduler s;
+        s.tiers.readBudget = budget;
+        s.tiers.farShare = budget / 2;
+        std::vector<std::uint32_t> out, lastRead(kCount, 0), maxGap(kCount, 0);
+        std::vector<std::uint8_t> taken(kCount, 0);
+        for (std::uint32_t f = 1; f <= 2000; ++f) {
+            s.plan(t, nearby, p, cam, R, maxDistance, out);
+            const UpdateScheduler::Stats& st = s.stats();
+            if (out.size() > budget || st.near + st.visible + st.offscreen + st.far != out.size()) {
+                std::printf("budget %zu frame %u: %zu reads, stats %zu\n", budget, f, out.size(),
+                    st.near + st.visible + st.offscreen + st.far);
+                return 1;
+            }
+            for (const std::uint32_t i : out) {
+                if (taken[i]++) {
+                    std::printf("budget %zu frame %u: row %u read twice\n", budget, f, i);
+                    return 1;
+                }
+                maxGap[i] = std::max(maxGap[i], f - lastRead[i]);
+                lastRead[i] = f;
+            }
+            for (const std::uint32_t i : out) taken[i] = 0;
+        }
+
+        std::uint32_t nearGap = 0, farGap = 0;
+        for (std::size_t i = 0; i < kCount; ++i) {
+            if (distSq(i) < s.tiers.nearRadius * s.tiers.nearRadius) nearGap = std::max(nearGap, maxGap[i]);
+            else if (distSq(i) >= cellRadius * cellRadius) farGap = std::max(farGap, maxGap[i]);
+        }
+        // ближние — каждый кадр; дальние хоть раз за прогон
+        const bool ok = nearGap == 1 && farGap > 0 && farGap < 2000;
+        failed += !ok;
+        std::printf("budget %4zu: near gap %u, far gap %u %s\n", budget, nearGap, farGap, ok ? "ok" : "FAIL");
+    }
+    return failed ? 1 : 0;
+}